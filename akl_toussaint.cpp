@@ -0,0 +1,125 @@
+#include "akl_toussaint.h"
+#include "endpoint.h"
+#include "monotone_chain_hull.h"
+
+namespace
+{
+	/* extreme points in the directions (-1,0), (-1,-1), (0,-1), (1,-1),
+	   (1,0), (1,1), (0,1), (-1,1), that is counter-clockwise from the leftmost */
+	struct extremes
+	{
+		point p[8];
+		double key[8];
+
+		extremes()
+		{
+			for (unsigned j = 0; j < 8; j++)
+				key[j] = -infinity;
+		}
+
+		void add(point q, const double * k)
+		{
+			for (unsigned j = 0; j < 8; j++)
+			{
+				if (k[j] > key[j])
+				{
+					key[j] = k[j];
+					p[j] = q;
+				}
+			}
+		}
+
+		void merge(const extremes & other)
+		{
+			for (unsigned j = 0; j < 8; j++)
+			{
+				if (other.key[j] > key[j])
+				{
+					key[j] = other.key[j];
+					p[j] = other.p[j];
+				}
+			}
+		}
+	};
+
+	void scan(const double * coordinates, unsigned begin, unsigned end, extremes & e)
+	{
+		for (unsigned i = begin; i < end; i++)
+		{
+			double x = coordinates[2*i];
+			double y = coordinates[2*i+1];
+			double k[8] = { -x, -x-y, -y, x-y, x, x+y, y, y-x };
+			e.add(point(x, y), k);
+		}
+	}
+
+	// polygon is closed, its first point is repeated at the end
+	bool inside(const std::vector<point> & polygon, point p)
+	{
+		for (unsigned i = 0; i + 1 < polygon.size(); i++)
+		{
+			if (cross(polygon[i], polygon[i+1], p) <= 0)
+				return false;
+		}
+		return true;
+	}
+}
+
+std::vector<double> akl_toussaint_filter(const std::vector<double> & coordinates, unsigned & removed, ThreadPool * pool)
+{
+	removed = 0;
+	unsigned n = (unsigned)coordinates.size() / 2;
+	if (n < 4)
+		return coordinates;
+
+	ThreadPool serial(1);
+	if (!pool)
+		pool = &serial;
+
+	// extreme points of every slice in one pass
+	std::vector<extremes> slice_extremes(pool->size());
+	unsigned slices = pool->parallel_for(n, [&](unsigned slice, unsigned begin, unsigned end)
+	{
+		scan(coordinates.data(), begin, end, slice_extremes[slice]);
+	});
+
+	extremes e;
+	for (unsigned i = 0; i < slices; i++)
+		e.merge(slice_extremes[i]);
+
+	// octagon without repeated corners
+	std::vector<point> polygon;
+	for (unsigned j = 0; j < 8; j++)
+	{
+		if (polygon.empty() || e.p[j] != polygon.back())
+			polygon.push_back(e.p[j]);
+	}
+	if (polygon.size() > 1 && polygon.front() == polygon.back())
+		polygon.pop_back();
+	if (polygon.size() < 3)
+		return coordinates;
+	polygon.push_back(polygon.front());
+
+	// drop the points inside, slices are joined in input order
+	std::vector<std::vector<double> > slice_points(slices);
+	pool->parallel_for(n, [&](unsigned slice, unsigned begin, unsigned end)
+	{
+		std::vector<double> & kept = slice_points[slice];
+		for (unsigned i = begin; i < end; i++)
+		{
+			point p = point(coordinates[2*i], coordinates[2*i+1]);
+			if (!inside(polygon, p))
+			{
+				kept.push_back(p.x);
+				kept.push_back(p.y);
+			}
+		}
+	});
+
+	std::vector<double> points;
+	for (unsigned i = 0; i < slices; i++)
+		points.insert(points.end(), slice_points[i].begin(), slice_points[i].end());
+
+	removed = n - (unsigned)points.size() / 2;
+	return points;
+}
@@ -0,0 +1,13 @@
+#ifndef AKL_TOUSSAINT_H_
+#define AKL_TOUSSAINT_H_
+
+#include <vector>
+#include "thread_pool.h"
+
+/* Akl-Toussaint heuristic: drops the points strictly inside the polygon of the
+   8 extreme points (smallest and largest x, y, x+y and x-y), none of them can be
+   on the hull; the remaining points keep their order, removed gets the number
+   of dropped points */
+std::vector<double> akl_toussaint_filter(const std::vector<double> &, unsigned & removed, ThreadPool * = 0);
+
+#endif
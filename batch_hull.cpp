@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <cstring>
+
+#include "batch_hull.h"
+#include "monotone_chain_hull.h"
+
+namespace
+{
+	// point::operator < inlined, the sorts of small groups are mostly comparisons
+	bool smaller(point a, point b)
+	{
+		return a.x < b.x || (a.x == b.x && a.y < b.y);
+	}
+
+	// hulls of a range of groups, written one after another
+	struct slice_hulls
+	{
+		std::vector<point> points;	// scratch, sized for the largest group
+		std::vector<point> hull;
+		std::vector<double> coordinates;
+		size_t first_offset;		// where the slice goes in the output
+	};
+}
+
+void batch_convex_hull(const std::vector<double> & coordinates, const std::vector<unsigned> & offsets,
+	std::vector<double> & hulls, std::vector<unsigned> & hull_offsets, ThreadPool & pool)
+{
+	unsigned groups = offsets.empty() ? 0 : (unsigned)offsets.size() - 1;
+	hull_offsets.resize(groups + 1);
+	hull_offsets[0] = 0;
+	hulls.clear();
+	if (groups == 0)
+		return;
+
+	// hull sizes go to hull_offsets[i+1] first and are summed up afterwards
+	std::vector<slice_hulls> slices(pool.size());
+	unsigned used = pool.parallel_for(groups, [&](unsigned slice, unsigned begin, unsigned end)
+	{
+		slice_hulls & s = slices[slice];
+		for (unsigned i = begin; i < end; i++)
+		{
+			unsigned n = offsets[i+1] - offsets[i];
+			if (n == 0)
+			{
+				// its offset may be the end of the input, which must not be indexed
+				hull_offsets[i+1] = 0;
+				continue;
+			}
+			if (s.points.size() < n)
+			{
+				s.points.resize(n);
+				s.hull.resize(2*n);
+			}
+
+			const double * p = &coordinates[2*(size_t)offsets[i]];
+			for (unsigned j = 0; j < n; j++)
+				s.points[j] = point(p[2*j], p[2*j+1]);
+			std::sort(s.points.begin(), s.points.begin() + n, smaller);
+
+			unsigned h = monotone_chain(s.points.data(), n, s.hull.data());
+			for (unsigned j = 0; j < h; j++)
+			{
+				s.coordinates.push_back(s.hull[j].x);
+				s.coordinates.push_back(s.hull[j].y);
+			}
+			hull_offsets[i+1] = h;
+		}
+	});
+
+	for (unsigned i = 0; i < groups; i++)
+		hull_offsets[i+1] += hull_offsets[i];
+
+	// slices hold consecutive groups, so each one is a single block of the output
+	hulls.resize(2*(size_t)hull_offsets[groups]);
+	size_t position = 0;
+	for (unsigned i = 0; i < used; i++)
+	{
+		slices[i].first_offset = position;
+		position += slices[i].coordinates.size();
+	}
+	pool.parallel_for(used, [&](unsigned, unsigned begin, unsigned end)
+	{
+		for (unsigned i = begin; i < end; i++)
+		{
+			if (!slices[i].coordinates.empty())
+				memcpy(&hulls[slices[i].first_offset], slices[i].coordinates.data(),
+					slices[i].coordinates.size() * sizeof(double));
+		}
+	});
+}
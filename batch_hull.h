@@ -0,0 +1,16 @@
+#ifndef BATCH_HULL_H_
+#define BATCH_HULL_H_
+
+#include <vector>
+#include "thread_pool.h"
+
+/* hulls of many small point groups at once: group i holds the points
+   offsets[i] to offsets[i+1]-1 of coordinates, offsets has one entry more than
+   there are groups; the hull of group i is written to the points hull_offsets[i]
+   to hull_offsets[i+1]-1 of hulls, in the same order as MonotoneChainHull;
+   groups are split across the pool, every slice sorts in its own scratch
+   buffers, so nothing is allocated per group */
+void batch_convex_hull(const std::vector<double> & coordinates, const std::vector<unsigned> & offsets,
+	std::vector<double> & hulls, std::vector<unsigned> & hull_offsets, ThreadPool &);
+
+#endif
@@ -0,0 +1,201 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hull_kernel.h"
+#include "quickhull.h"
+#include "thread_pool.h"
+
+/* times the hull code without a display:
+     trapezoid_bench [points] [threads]
+   points in the unit disc, 2000000 by default; the pooled hull runs on 1 up to
+   threads threads, all cores by default; the first split of QuickHull is timed
+   on its own against the code it replaced */
+
+namespace
+{
+	const unsigned RUNS = 5;
+
+	typedef std::chrono::steady_clock clock_type;
+
+	double milliseconds(clock_type::time_point from, clock_type::time_point to)
+	{
+		return std::chrono::duration<double, std::milli>(to - from).count();
+	}
+
+	// uniform in the unit disc, the hull has few points and every split sees most of them
+	std::vector<double> disc_points(unsigned n)
+	{
+		std::mt19937 random(1);
+		std::uniform_real_distribution<double> coordinate(-1, 1);
+		std::vector<double> coords;
+		coords.reserve(2 * (size_t)n);
+		while (coords.size() < 2 * (size_t)n)
+		{
+			double x = coordinate(random), y = coordinate(random);
+			if (x * x + y * y < 1)
+			{
+				coords.push_back(x);
+				coords.push_back(y);
+			}
+		}
+		return coords;
+	}
+
+	std::ostream & label(const std::string & text)
+	{
+		return std::cout << std::left << std::setw(28) << text;
+	}
+
+	// best of RUNS, the first one pays for page faults
+	template <class F>
+	double best_time(F run)
+	{
+		double best = 0;
+		for (unsigned r = 0; r < RUNS; r++)
+		{
+			clock_type::time_point start = clock_type::now();
+			run();
+			double t = milliseconds(start, clock_type::now());
+			if (r == 0 || t < best)
+				best = t;
+		}
+		return best;
+	}
+
+	// QuickHull::distance() before split_farthest(), squared distance of p from line ab
+	double old_distance(point a, point b, point p)
+	{
+		double x, y, u;
+		u = ((p.x-a.x)*(b.x-a.x) + (p.y-a.y)*(b.y-a.y)) / ((b.x-a.x)*(b.x-a.x) + (b.y-a.y)*(b.y-a.y));
+		x = a.x + u*(b.x-a.x);
+		y = a.y + u*(b.y-a.y);
+		return ((x-p.x)*(x-p.x) + (y-p.y)*(y-p.y));
+	}
+
+	double old_point_location(point a, point b, point p)
+	{
+		return (a.x-b.x)*(p.y-b.y) - (p.x-b.x)*(a.y-b.y);
+	}
+
+	point old_fartherest_point(point a, point b, const std::vector<point> & points)
+	{
+		point max_point(0.0, 0.0);
+		double max_distance = 0.0;
+		for (unsigned i = 0; i < points.size(); i++)
+		{
+			double point_distance = old_distance(a, b, points.at(i));
+			if (point_distance > max_distance)
+			{
+				max_distance = point_distance;
+				max_point = points.at(i);
+			}
+		}
+		return max_point;
+	}
+
+	/* one split of the points left and right of the line through the extreme
+	   points, the step every subproblem of QuickHull takes: split_farthest() with
+	   and without AVX2, and the old passes, one for the farthest point and one
+	   to sort the points into the two sides */
+	void split_timing(const std::vector<double> & coords)
+	{
+		point_block block;
+		std::vector<point> points;
+		for (size_t i = 0; i + 1 < coords.size(); i += 2)
+		{
+			block.push_back(point(coords[i], coords[i + 1]));
+			points.push_back(point(coords[i], coords[i + 1]));
+		}
+		point left = points[0], right = points[0];
+		for (size_t i = 1; i < points.size(); i++)
+		{
+			if (points[i] < left)
+				left = points[i];
+			if (right < points[i])
+				right = points[i];
+		}
+
+		point_block upper, lower;
+		split_result split;
+		double kernel = best_time([&]()
+		{
+			split = split_farthest(block, 0, block.size(), left, right, right, left, upper, lower);
+		});
+		double scalar = best_time([&]()
+		{
+			split_farthest_scalar(block, 0, block.size(), left, right, right, left, upper, lower);
+		});
+
+		std::vector<point> old_upper, old_lower;
+		point old_far0, old_far1;
+		double two_pass = best_time([&]()
+		{
+			old_upper.clear();
+			old_lower.clear();
+			for (unsigned i = 0; i < points.size(); i++)
+			{
+				point p = points[i];
+				if (old_point_location(left, right, p) > 0)
+					old_upper.push_back(p);
+				if (old_point_location(left, right, p) < 0)
+					old_lower.push_back(p);
+			}
+			old_far0 = old_fartherest_point(left, right, old_upper);
+			old_far1 = old_fartherest_point(right, left, old_lower);
+		});
+		bool same = old_far0 == split.far0 && old_far1 == split.far1 &&
+			old_upper.size() == upper.size() && old_lower.size() == lower.size();
+
+		label(hull_kernel_avx2() ? "split_farthest, AVX2" : "split_farthest, no AVX2") << kernel << " ms, "
+			<< upper.size() << " + " << lower.size() << " points" << std::endl;
+		label("split_farthest_scalar") << scalar << " ms, " << two_pass / scalar << "x faster than two passes" << std::endl;
+		label("two passes, before kernel") << two_pass << " ms, " << two_pass / kernel << "x split_farthest"
+			<< (same ? "" : ", different result") << std::endl;
+	}
+
+	void hull_scaling(const std::vector<double> & coords, unsigned max_threads)
+	{
+		size_t hull_size = 0;
+		double serial = best_time([&]()
+		{
+			QuickHull hull(coords);
+			while (!hull.next_step());
+			hull_size = hull.get_convex_hull().size() / 2;
+		});
+		label("quickhull serial") << serial << " ms, " << hull_size << " hull points" << std::endl;
+
+		for (unsigned threads = 1; threads <= max_threads; threads++)
+		{
+			ThreadPool pool(threads);
+			double pooled = best_time([&]()
+			{
+				QuickHull hull(coords, pool);
+			});
+			label("quickhull pooled, " + std::to_string(threads) + (threads == 1 ? " thread" : " threads")) << pooled << " ms, " << serial / pooled << "x serial" << std::endl;
+		}
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	unsigned n = argc > 1 ? (unsigned)atoi(argv[1]) : 2000000;
+	unsigned threads = argc > 2 ? (unsigned)atoi(argv[2]) : std::thread::hardware_concurrency();
+	if (n < 3 || threads == 0)
+	{
+		std::cerr << "usage: trapezoid_bench [points] [threads]" << std::endl;
+		return 1;
+	}
+
+	std::vector<double> coords = disc_points(n);
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << n << " points, hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+	hull_scaling(coords, threads);
+	split_timing(coords);
+	return 0;
+}
@@ -0,0 +1,129 @@
+#include <cmath>
+
+#include "bulk_input.h"
+#include "log.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	// compiled for AVX2 separately and picked at run time
+	#define BULK_INPUT_AVX2
+	#define AVX2_TARGET __attribute__((target("avx2")))
+	#include <immintrin.h>
+#elif defined(__AVX2__)
+	// compiled with /arch:AVX2, the whole program requires it
+	#define BULK_INPUT_AVX2
+	#define AVX2_TARGET
+	#include <immintrin.h>
+#endif
+
+namespace
+{
+	/* bounds of x,y pairs [begin, end) into min_x, min_y, max_x, max_y;
+	   v - v is 0 for every finite v and NaN otherwise, false if a value is not finite */
+	bool scan_scalar(const double * v, size_t begin, size_t end, double * bounds)
+	{
+		bool finite = true;
+		for (size_t i = begin; i < end; i += 2)
+		{
+			double x = v[i];
+			double y = v[i + 1];
+			finite &= (x - x == 0) & (y - y == 0);
+			bounds[0] = x < bounds[0] ? x : bounds[0];
+			bounds[1] = y < bounds[1] ? y : bounds[1];
+			bounds[2] = x > bounds[2] ? x : bounds[2];
+			bounds[3] = y > bounds[3] ? y : bounds[3];
+		}
+		return finite;
+	}
+
+#ifdef BULK_INPUT_AVX2
+	// two pairs per step, x in the even lanes and y in the odd ones; the rest is left for scan_scalar
+	AVX2_TARGET
+	size_t scan_avx2(const double * v, size_t end, double * bounds, bool & finite)
+	{
+		const __m256d zero = _mm256_setzero_pd();
+		__m256d low = _mm256_set1_pd(HUGE_VAL);
+		__m256d high = _mm256_set1_pd(-HUGE_VAL);
+		__m256d bad = zero;
+
+		size_t i = 0;
+		for (; i + 4 <= end; i += 4)
+		{
+			__m256d p = _mm256_loadu_pd(v + i);
+			bad = _mm256_or_pd(bad, _mm256_cmp_pd(_mm256_sub_pd(p, p), zero, _CMP_NEQ_UQ));
+			low = _mm256_min_pd(low, p);
+			high = _mm256_max_pd(high, p);
+		}
+
+		double l[4];
+		double h[4];
+		_mm256_storeu_pd(l, low);
+		_mm256_storeu_pd(h, high);
+		for (unsigned j = 0; j < 4; j++)
+		{
+			bounds[j & 1] = l[j] < bounds[j & 1] ? l[j] : bounds[j & 1];
+			bounds[2 + (j & 1)] = h[j] > bounds[2 + (j & 1)] ? h[j] : bounds[2 + (j & 1)];
+		}
+		finite = _mm256_movemask_pd(bad) == 0;
+		return i;
+	}
+
+	bool detect_avx2()
+	{
+	#if defined(__GNUC__)
+		return __builtin_cpu_supports("avx2");
+	#else
+		return true;
+	#endif
+	}
+
+	const bool use_avx2 = detect_avx2();
+#endif
+
+	bool scan(const double * v, size_t end, double * bounds)
+	{
+		bounds[0] = bounds[1] = HUGE_VAL;
+		bounds[2] = bounds[3] = -HUGE_VAL;
+
+		size_t begin = 0;
+		bool finite = true;
+	#ifdef BULK_INPUT_AVX2
+		if (use_avx2)
+			begin = scan_avx2(v, end, bounds, finite);
+	#endif
+		return scan_scalar(v, begin, end, bounds) && finite;
+	}
+}
+
+BulkInput::BulkInput(const std::vector<double> & values, unsigned stride)
+	: flags(INPUT_OK), whole((unsigned)(values.size() / stride)), count(whole),
+	records(values.empty() ? 0 : &values[0])
+{
+	if (values.size() % stride != 0)
+		flags |= INPUT_TRAILING;
+
+	if (!scan(records, (size_t)whole * stride, bounds))
+	{
+		// rare, so the good records are picked out one by one
+		flags |= INPUT_NOT_FINITE;
+		copy.reserve((size_t)whole * stride);
+		for (unsigned r = 0; r < whole; r++)
+		{
+			const double * v = records + (size_t)r * stride;
+			bool finite = true;
+			for (unsigned k = 0; k < stride; k++)
+				finite = finite && std::isfinite(v[k]);
+			if (!finite)
+				continue;
+			copy.insert(copy.end(), v, v + stride);
+			kept.push_back(r);
+		}
+		count = (unsigned)kept.size();
+		records = copy.empty() ? 0 : &copy[0];
+		scan(records, copy.size(), bounds);
+	}
+
+	if (flags & INPUT_TRAILING)
+		LOG(LOG_LEVEL_WARNING, "Ignored " << values.size() % stride << " values after the last whole record.");
+	if (flags & INPUT_NOT_FINITE)
+		LOG(LOG_LEVEL_WARNING, "Skipped " << whole - count << " records with coordinates that are not finite.");
+}
@@ -0,0 +1,52 @@
+#ifndef BULK_INPUT_H_
+#define BULK_INPUT_H_
+
+#include <vector>
+
+// flags of what was wrong with an input array, or-ed together
+enum input_error
+{
+	INPUT_OK = 0,
+	INPUT_TRAILING = 1,	// values after the last whole record were ignored
+	INPUT_NOT_FINITE = 2	// records with an infinite or NaN coordinate were skipped
+};
+
+/* input of the engines checked in one go: x,y pairs grouped into records of
+   stride values (2 for points, 4 for segments), the whole records with finite
+   coordinates and their bounds. the input is used in place when nothing has to
+   be skipped, so it must outlive the BulkInput; otherwise the good records are copied */
+class BulkInput
+{
+public:
+	BulkInput(const std::vector<double> & values, unsigned stride);
+
+	unsigned errors() const { return flags; }
+
+	// good records, their values and the position of each in the input
+	unsigned size() const { return count; }
+	const double * data() const { return records; }
+	unsigned origin(unsigned record) const { return kept.empty() ? record : kept[record]; }
+
+	// records in the input, good or not
+	unsigned input_size() const { return whole; }
+
+	// +-infinity if there are no good records
+	double min_x() const { return bounds[0]; }
+	double min_y() const { return bounds[1]; }
+	double max_x() const { return bounds[2]; }
+	double max_y() const { return bounds[3]; }
+
+private:
+	unsigned flags;
+	unsigned whole;
+	unsigned count;
+	const double * records;
+	std::vector<double> copy;
+	std::vector<unsigned> kept;
+	double bounds[4];
+
+	BulkInput(const BulkInput &);
+	BulkInput & operator = (const BulkInput &);
+};
+
+#endif
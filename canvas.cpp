@@ -15,8 +15,10 @@
 #include <algorithm>
 #include <iterator>
 #include <iostream>
+#include <limits>
 
 #include "canvas.h"
+#include "log.h"
 
 BEGIN_EVENT_TABLE(Canvas, wxGLCanvas)
 	EVT_SIZE(Canvas::on_resize)
@@ -27,6 +29,7 @@ BEGIN_EVENT_TABLE(Canvas, wxGLCanvas)
 	EVT_RIGHT_DOWN(Canvas::mouse_right_click)
 	EVT_LEAVE_WINDOW(Canvas::mouse_left_window)
 	EVT_ENTER_WINDOW(Canvas::mouse_endered_window)
+	EVT_MOUSEWHEEL(Canvas::mouse_wheel)
 	EVT_KEY_DOWN(Canvas::on_key_pressed)
 	EVT_IDLE(Canvas::on_idle)
 	EVT_TIMER(TIMER_ID, Canvas::on_timer)
@@ -34,7 +37,10 @@ END_EVENT_TABLE()
 
 Canvas::Canvas(wxWindow* parent)
 	: wxGLCanvas(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize,
-	  wxBORDER_NONE|wxFULL_REPAINT_ON_RESIZE, wxT("canvas")), timer(this, TIMER_ID)
+	  wxBORDER_NONE|wxFULL_REPAINT_ON_RESIZE, wxT("canvas")),
+	  intersection_index(1, TILE_PIXELS / MAX_ZOOM), wall_index(2, TILE_PIXELS / MAX_ZOOM),
+	  finished_index(4, TILE_PIXELS / MAX_ZOOM), quickhull_processed_index(2, TILE_PIXELS / MAX_ZOOM),
+	  gift_processed_index(2, TILE_PIXELS / MAX_ZOOM), timer(this, TIMER_ID)
 {
 	current_mode = TRAPEZOID;
 	color_mode = BLUE;
@@ -42,17 +48,54 @@ Canvas::Canvas(wxWindow* parent)
 	display_guideline = false;
 	drawing = true;
 	display_solution = false;
+	playback_speed = 1;
+	due_steps = 0;
+	input_generation = 0;
+	frame_generation = 0;
+	screen_x = screen_y = 0;
+	win_width = win_height = 0;
+	zoom = 1;
+	pan_x = pan_y = 0;
+	mouse_x = mouse_y = 0;
+}
+
+// messages of the engines are written to the redirected std::cout here, on the GUI thread
+void Canvas::on_idle(wxIdleEvent& event)
+{
+	log_drain(std::cout);
 }
 
 void Canvas::on_timer(wxTimerEvent& event)
 {
+	// the steps due since the last tick are taken at once, only the newest one is drawn
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	due_steps += steps_per_second() * std::chrono::duration<double>(now - last_tick).count();
+	last_tick = now;
+
+	unsigned count = std::numeric_limits<unsigned>::max();
+	if (!worker.fast_forward())
+	{
+		if (due_steps < 1)
+			return;
+		count = (unsigned)std::min(due_steps, (double)SNAPSHOT_QUEUE);
+		due_steps -= count;
+	}
 
-	if ((current_mode == TRAPEZOID && trapezoid.next_step()) ||
-		(current_mode == GIFT && gift.next_step()) ||
-		(current_mode == QUICKHULL && quickhull.next_step()))
+	std::shared_ptr<const frame> next = worker.take(count);
+	if (!next)
+	{
+		// the worker is behind, show its next step as soon as it comes
+		due_steps = std::min(due_steps + count, 1.0);
+		return;
+	}
+	shown = next;
+	frame_generation++;
+	keep_histories(*shown);
+
+	if (shown->finished)
 	{
 		timer.Stop();
-		std::cout << "Finished." << std::endl;
+		LOG(LOG_LEVEL_INFO, "Finished.");
 		display_guideline = true;
 	}
 
@@ -65,22 +108,26 @@ void Canvas::set_mode(mode m)
 	drawing = true;
 	display_solution = false;
 	if (m == TRAPEZOID)
-		std::cout << "Trapezoid Sweep mode active. Left click to draw new segment, right click to switch color." << std::endl;
+		LOG(LOG_LEVEL_INFO, "Trapezoid Sweep mode active. Left click to draw new segment, right click to switch color.");
 	if (m == QUICKHULL)
-		std::cout << "QuickHull mode active. Left click to draw new point." << std::endl;
+		LOG(LOG_LEVEL_INFO, "QuickHull mode active. Left click to draw new point.");
 	if (m == GIFT)
-		std::cout << "Gift Wrapping mode active. Left click to draw new point." << std::endl;
+		LOG(LOG_LEVEL_INFO, "Gift Wrapping mode active. Left click to draw new point.");
 	new_preview();
 }
 
 void Canvas::clear()
 {
-	std::cout << "Plane cleared." << std::endl;
+	LOG(LOG_LEVEL_INFO, "Plane cleared.");
 	drawing = true;
 	display_solution = false;
 	hull_points.clear();
 	red_endpoints.clear();
 	blue_endpoints.clear();
+	input_generation++;
+	red_buffer.reset();
+	blue_buffer.reset();
+	hull_point_buffer.reset();
 	new_preview();
 }
 
@@ -89,13 +136,20 @@ void Canvas::start()
 	drawing = false;
 	display_solution = true;
 	display_guideline = false;
-	std::cout << "Started." << std::endl;
+	LOG(LOG_LEVEL_INFO, "Started.");
+	shown.reset();
+	worker.set_fast_forward(false);
 	if (current_mode == TRAPEZOID)
 		trapezoid_sweep();
 	if (current_mode == QUICKHULL)
 		quick_hull();
 	if (current_mode == GIFT)
 		gift_wrapping_hull();
+
+	// the first frame is shown as soon as the worker publishes it
+	due_steps = 1;
+	last_tick = std::chrono::steady_clock::now();
+	timer.Start(PLAYBACK_TICK);
 	drawing = true;
 }
 
@@ -105,16 +159,42 @@ void Canvas::switch_color()
 	{
 		color_mode = RED;
 		new_segment.color = RED;
-		std::cout << "Switched from blue to red." << std::endl;
+		LOG(LOG_LEVEL_INFO, "Switched from blue to red.");
 	}
 	else
 	{
 		color_mode = BLUE;
 		new_segment.color = BLUE;
-		std::cout << "Switched from red to blue." << std::endl;
+		LOG(LOG_LEVEL_INFO, "Switched from red to blue.");
 	}
 }
 
+void Canvas::faster()
+{
+	playback_speed = std::min(playback_speed * 2, 256.0);
+	LOG(LOG_LEVEL_INFO, "Playing " << steps_per_second() << " steps per second.");
+}
+
+void Canvas::slower()
+{
+	playback_speed = std::max(playback_speed / 2, 1.0 / 16);
+	LOG(LOG_LEVEL_INFO, "Playing " << steps_per_second() << " steps per second.");
+}
+
+void Canvas::toggle_fast_forward()
+{
+	worker.set_fast_forward(!worker.fast_forward());
+	LOG(LOG_LEVEL_INFO, "Fast forward " << (worker.fast_forward() ? "on." : "off."));
+}
+
+void Canvas::reset_view()
+{
+	zoom = 1;
+	pan_x = pan_y = 0;
+	LOG(LOG_LEVEL_INFO, "View reset.");
+	Refresh(false);
+}
+
 void Canvas::render()
 {
 	wxPaintDC dc(this);
@@ -146,14 +226,14 @@ void Canvas::render()
 
 	render_guideline();
 
-	if (display_solution)
+	if (display_solution && shown)
 	{
-		if (current_mode == TRAPEZOID)
-			render_trapezoid_sweep();
-		else if (current_mode == GIFT)
-			render_gift_hull();
+		if (shown->algorithm == TRAPEZOID)
+			render_trapezoid_sweep(*shown);
+		else if (shown->algorithm == GIFT)
+			render_gift_hull(*shown);
 		else
-			render_quickhull();
+			render_quickhull(*shown);
 	}
 
 	else
@@ -180,8 +260,17 @@ void Canvas::on_resize(wxSizeEvent& event)
 
 void Canvas::mouse_moved(wxMouseEvent& event)
 {
-	mouse_x = event.GetX();
-	mouse_y = win_height - event.GetY();
+	if (event.MiddleIsDown())
+	{
+		pan_x -= (event.GetX() - screen_x) / zoom;
+		pan_y += (event.GetY() - screen_y) / zoom;
+		Refresh(false);
+	}
+
+	screen_x = event.GetX();
+	screen_y = event.GetY();
+	mouse_x = pan_x + screen_x / zoom;
+	mouse_y = pan_y + (win_height - screen_y) / zoom;
 
 	if (drawing) 
 	{
@@ -214,7 +303,7 @@ void Canvas::mouse_left_click(wxMouseEvent& event)
 
 	if (current_mode == GIFT || current_mode == QUICKHULL)
 	{
-		std::cout << "New point [" << mouse_x << "," << mouse_y << "]." << std::endl;
+		LOG(LOG_LEVEL_INFO, "New point [" << mouse_x << "," << mouse_y << "].");
 		hull_points.push_back(mouse_x);
 		hull_points.push_back(mouse_y);
 		Refresh(false);
@@ -257,6 +346,22 @@ void Canvas::mouse_endered_window(wxMouseEvent& event)
 	}
 }
 
+void Canvas::mouse_wheel(wxMouseEvent& event)
+{
+	double old_zoom = zoom;
+	if (event.GetWheelRotation() > 0)
+		zoom = std::min(zoom * ZOOM_STEP, MAX_ZOOM);
+	else
+		zoom = std::max(zoom / ZOOM_STEP, MIN_ZOOM);
+
+	// the point under the cursor stays there, the wheel can turn before the mouse moves
+	double x = pan_x + event.GetX() / old_zoom;
+	double y = pan_y + (win_height - event.GetY()) / old_zoom;
+	pan_x = x - (x - pan_x) * old_zoom / zoom;
+	pan_y = y - (y - pan_y) * old_zoom / zoom;
+	Refresh(false);
+}
+
 void Canvas::init_gl()
 {
 	glDepthFunc(GL_LESS);
@@ -274,7 +379,7 @@ void Canvas::set_projection_matrix()
 
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
-	gluOrtho2D(0,win_width,0,win_height);
+	gluOrtho2D(pan_x, pan_x + win_width / zoom, pan_y, pan_y + win_height / zoom);
 }
 
 void Canvas::set_modelview_matrix()
@@ -283,109 +388,107 @@ void Canvas::set_modelview_matrix()
 	glLoadIdentity();	
 }
 
-void Canvas::render_trapezoid_sweep()
+// appends what the frame added to the histories, finished trapezoids are expanded right away
+void Canvas::keep_histories(const frame & f)
+{
+	intersections.insert(intersections.end(), f.intersections.begin(), f.intersections.end());
+	processed.insert(processed.end(), f.processed.begin(), f.processed.end());
+	if (f.finished_trapezoids.empty())
+		return;
+
+	TrapezoidSweep::trapezoid_corners(*f.blue_segments, f.finished_trapezoids.data(), f.finished_trapezoids.size(),
+		f.trapezoid_bottom, f.trapezoid_top, finished_corners);
+	TrapezoidSweep::trapezoid_walls(*f.blue_segments, f.finished_trapezoids.data(), f.finished_trapezoids.size(),
+		f.trapezoid_bottom, f.trapezoid_top, wall_corners);
+}
+
+void Canvas::render_trapezoid_sweep(const frame & f)
 {		
 	// point being processed
 	if (timer.IsRunning())
 	{
 		glPointSize(5);
-		if (trapezoid.current_segment_color() == RED)
+		if (f.endpoint_color == RED)
 			glColor3ub(255, 0, 0);
 		else 
 			glColor3ub(0, 0, 255);
-		glBegin(GL_POINTS);
-		glVertex2d(trapezoid.current_endpoint_x(),trapezoid.current_endpoint_y());
-		glEnd();
+		float current_point[] = { (float)f.endpoint_x, (float)f.endpoint_y };
+		draw_vertices(GL_POINTS, current_point, 1);
 	}
 
 	// intersections (black)
-	glEnableClientState(GL_VERTEX_ARRAY);
-	const std::vector<double> & intersections = trapezoid.intersections();
-	if (!intersections.empty())
-	{
-		timer.IsRunning() ? glPointSize(4) : glPointSize(5);
-		glColor3f(0.0f, 0.0f, 0.0f);
-		glVertexPointer(2, GL_DOUBLE, 0, &intersections[0]);
-		glDrawArrays(GL_POINTS,0,(GLsizei)intersections.size()/2);
-	}
-	glDisableClientState(GL_VERTEX_ARRAY);
+	double point_size = timer.IsRunning() ? 4 : 5;
+	glPointSize((GLfloat)point_size);
+	glColor3f(0.0f, 0.0f, 0.0f);
+	render_results(intersection_index, intersection_buffer, intersections, GL_POINTS, point_size / 2);
 
 	render_segments();
 
-	glEnableClientState(GL_VERTEX_ARRAY);
 	// sweep line (black)
 	if (timer.IsRunning())
 	{		
 		glEnable(GL_LINE_STIPPLE);
 		glLineStipple(1,0xf0f0);
 		glColor3ub(120, 120, 120);
-		glBegin(GL_LINES);
-		glVertex2d(trapezoid.sweepline_x(),0.0);
-		glVertex2d(trapezoid.sweepline_x(),win_height);
-		glEnd();
+		float sweep_line[] = { (float)f.sweep_x, (float)pan_y, (float)f.sweep_x, (float)(pan_y + win_height / zoom) };
+		draw_vertices(GL_LINES, sweep_line, 2);
 		glDisable(GL_LINE_STIPPLE);
 	}
 
+	current_walls.clear();
+	TrapezoidSweep::trapezoid_walls(*f.blue_segments, f.current_trapezoids.data(), f.current_trapezoids.size(),
+		f.trapezoid_bottom, f.trapezoid_top, current_walls);
+
 	//trapezoid walls (grey)
 	if (timer.IsRunning())
 		glColor3ub(220, 220, 220);
 	else
 		glColor3ub(235, 235, 235);
-	const std::vector<double> & walls = trapezoid.trapezoid_walls();
-	if (!walls.empty())
-	{
-		//glEnable(GL_LINE_STIPPLE);
-		//glLineStipple(1,0xf0f0);
-		glVertexPointer(2, GL_DOUBLE, 0, &walls[0]);
-		glDrawArrays(GL_LINES,0,(GLsizei)walls.size()/2);
-		//glDisable(GL_LINE_STIPPLE);
-	}
+	//glEnable(GL_LINE_STIPPLE);
+	//glLineStipple(1,0xf0f0);
+	render_results(wall_index, wall_buffer, wall_corners, GL_LINES, 0.5);
+	current_wall_buffer.sync(current_walls, frame_generation);
+	current_wall_buffer.draw(GL_LINES);
+	//glDisable(GL_LINE_STIPPLE);
 
 	//finished trapezoids (grey)
 	if (timer.IsRunning())
 		glColor3ub(243, 243, 243);
 	else
 		glColor3ub(255, 255, 255);
-	const std::vector<double> & finished = trapezoid.finished();
-	if (!finished.empty())
-	{
-		glVertexPointer(2, GL_DOUBLE, 0, &finished[0]);
-		glDrawArrays(GL_QUADS,0,(GLsizei)finished.size()/2);
-	}
+	render_results(finished_index, finished_buffer, finished_corners, GL_QUADS, 0.5);
 
-	// current trapezoids (yellow)
+	// current trapezoids (yellow), a few of them are rebuilt every step
 	if (timer.IsRunning())
 	{
-		const std::vector<double> & current = trapezoid.current();
-		if (!current.empty())
-		{
-			glColor3ub(255, 255, 200);
-			glVertexPointer(2, GL_DOUBLE, 0, &current[0]);
-			glDrawArrays(GL_QUADS,0,(GLsizei)current.size()/2);
-		}
+		std::vector<double> & current = current_corners;
+		current.clear();
+		TrapezoidSweep::trapezoid_corners(*f.blue_segments, f.current_trapezoids.data(), f.current_trapezoids.size(),
+			f.trapezoid_bottom, f.trapezoid_top, current);
+		glColor3ub(255, 255, 200);
+		current_buffer.sync(current, frame_generation);
+		current_buffer.draw(GL_QUADS);
 	}
-
-	glDisableClientState(GL_VERTEX_ARRAY);
 }
 
-void Canvas::render_gift_hull()
+void Canvas::render_gift_hull(const frame & f)
 {
 	// points being processed
-	const std::vector<double> & curr_line = gift.current_line();
-	const std::vector<double> & min_line = gift.min_line();
+	const std::vector<double> & curr_line = f.current_line;
+	const std::vector<double> & min_line = f.min_line;
 	if (curr_line.size() > 3 && min_line.size() > 3  && timer.IsRunning())
 	{
 		glPointSize(7);
-		glBegin(GL_POINTS);
-			// endpoint (red)
-			glColor3ub(255, 60, 50);
-			glVertex2d(curr_line[0],curr_line[1]);
-			// min point (red)
-			glVertex2d(min_line[2],min_line[3]);
-			// current point (blue)
-			glColor3ub(140, 170, 255);
-			glVertex2d(curr_line[2],curr_line[3]);
-		glEnd();
+
+		// endpoint and min point (red)
+		glColor3ub(255, 60, 50);
+		float ends[] = { (float)curr_line[0], (float)curr_line[1], (float)min_line[2], (float)min_line[3] };
+		draw_vertices(GL_POINTS, ends, 2);
+
+		// current point (blue)
+		glColor3ub(140, 170, 255);
+		float current_point[] = { (float)curr_line[2], (float)curr_line[3] };
+		draw_vertices(GL_POINTS, current_point, 1);
 	}
 
 	render_hull_points();
@@ -395,74 +498,46 @@ void Canvas::render_gift_hull()
 	{
 		//glColor3ub(81, 244, 0);
 		glColor3ub(140, 170, 255);
-		glBegin(GL_LINES);
-			glVertex2d(curr_line[0],curr_line[1]);
-			glVertex2d(curr_line[2],curr_line[3]);
-		glEnd();
+		float line[] = { (float)curr_line[0], (float)curr_line[1], (float)curr_line[2], (float)curr_line[3] };
+		draw_vertices(GL_LINES, line, 2);
 	}
 
 	// min line found so far (red)
 	if (min_line.size() > 3  && timer.IsRunning())
 	{
 		glColor3ub(255, 60, 50);
-		glBegin(GL_LINES);
-			glVertex2d(min_line[0],min_line[1]);
-			glVertex2d(min_line[2],min_line[3]);
-		glEnd();
+		float line[] = { (float)min_line[0], (float)min_line[1], (float)min_line[2], (float)min_line[3] };
+		draw_vertices(GL_LINES, line, 2);
 	}
 
-	glEnableClientState(GL_VERTEX_ARRAY);
-
-	// convex hull border (red)
-	const std::vector<double> & hull = gift.get_convex_hull();
-	if (!hull.empty())
-	{
-		glColor3ub(255, 160, 150);
-		glVertexPointer(2, GL_DOUBLE, 0, &hull[0]);
-
-		// close line when finished
-		if (timer.IsRunning())
-			glDrawArrays(GL_LINE_STRIP,0,(GLsizei)hull.size()/2);
-		else
-			glDrawArrays(GL_LINE_LOOP,0,(GLsizei)hull.size()/2);
-	}
+	// convex hull border (red), closed when finished
+	glColor3ub(255, 160, 150);
+	hull_buffer.sync(f.hull, frame_generation);
+	hull_buffer.draw(timer.IsRunning() ? GL_LINE_STRIP : GL_LINE_LOOP);
 
 	// all connections processed so far (grey)
-	const std::vector<double> & processed = gift.processed_lines();
 	if (timer.IsRunning())
 		glColor3ub(220, 220, 220);
 	else
 		glColor3ub(235, 235, 235);
-	if (!processed.empty())
-	{
-		glVertexPointer(2, GL_DOUBLE, 0, &processed[0]);
-		glDrawArrays(GL_LINES,0,(GLsizei)processed.size()/2);
-	}
-	glDisableClientState(GL_VERTEX_ARRAY);
+	render_results(gift_processed_index, gift_processed_buffer, processed, GL_LINES, 0.5);
 }
 
-void Canvas::render_quickhull()
+void Canvas::render_quickhull(const frame & f)
 {
 	// points to be processed in the next step (blue)
-	const std::vector<double> & current_points = quickhull.current_points();
-	glEnableClientState(GL_VERTEX_ARRAY);
-	if (!current_points.empty())
-	{
-		glPointSize(5);
-		glColor3ub(140, 170, 255);
-		glVertexPointer(2, GL_DOUBLE, 0, &current_points[0]);
-		glDrawArrays(GL_POINTS,0,(GLsizei)current_points.size()/2);
-	}
-	glDisableClientState(GL_VERTEX_ARRAY);
+	glPointSize(5);
+	glColor3ub(140, 170, 255);
+	current_buffer.sync(f.current_points, frame_generation);
+	current_buffer.draw(GL_POINTS);
 
-	const std::vector<double> & line = quickhull.current_line();
+	const std::vector<double> & line = f.current_line;
+	float current_line[4];
 	if (line.size() > 3)
 	{
-		glColor3ub(140, 170, 255);
-		glBegin(GL_POINTS);
-			glVertex2d(line[0],line[1]);
-			glVertex2d(line[2],line[3]);
-		glEnd();
+		for (unsigned i = 0; i < 4; i++)
+			current_line[i] = (float)line[i];
+		draw_vertices(GL_POINTS, current_line, 2);
 	}
 
 	render_hull_points();
@@ -471,78 +546,51 @@ void Canvas::render_quickhull()
 	if (line.size() > 3)
 	{
 		glColor3ub(140, 170, 255);
-		glBegin(GL_LINES);
-			glVertex2d(line[0],line[1]);
-			glVertex2d(line[2],line[3]);
-		glEnd();
+		draw_vertices(GL_LINES, current_line, 2);
 	}
 
 	// convex hull border found so far
-	glEnableClientState(GL_VERTEX_ARRAY);
-	const std::vector<double> & hull = quickhull.get_convex_hull();
-	if (!hull.empty())
-	{
-		glColor3ub(255, 160, 150);
-		glVertexPointer(2, GL_DOUBLE, 0, &hull[0]);
-		glDrawArrays(GL_LINE_LOOP,0,(GLsizei)hull.size()/2);
-	}
+	glColor3ub(255, 160, 150);
+	hull_buffer.sync(f.hull, frame_generation);
+	hull_buffer.draw(GL_LINE_LOOP);
 
 	// all connections processed so far (grey)
-	const std::vector<double> & processed = quickhull.processed_lines();
 	if (timer.IsRunning())
 		glColor3ub(220, 220, 220);
 	else
 		glColor3ub(235, 235, 235);
-	if (!processed.empty())
-	{
-		glVertexPointer(2, GL_DOUBLE, 0, &processed[0]);
-		glDrawArrays(GL_LINES,0,(GLsizei)processed.size()/2);
-	}		
-	glDisableClientState(GL_VERTEX_ARRAY);
+	render_results(quickhull_processed_index, quickhull_processed_buffer, processed, GL_LINES, 0.5);
 
-	const std::vector<double> & triangle = quickhull.processed_triangle();
+	const std::vector<double> & triangle = f.triangle;
 	if (triangle.size() > 5 && timer.IsRunning())
 	{
 		glColor3ub(243, 243, 255);
-		glBegin(GL_TRIANGLES);
-			glVertex2d(triangle[0],triangle[1]);
-			glVertex2d(triangle[2],triangle[3]);
-			glVertex2d(triangle[4],triangle[5]);
-		glEnd();
+		float corners[6];
+		for (unsigned i = 0; i < 6; i++)
+			corners[i] = (float)triangle[i];
+		draw_vertices(GL_TRIANGLES, corners, 3);
 	}
 }
 
 void Canvas::render_hull_points()
 {
-	if (hull_points.empty())
-		return;
-	glEnableClientState(GL_VERTEX_ARRAY);
+	hull_point_buffer.sync(hull_points, input_generation);
 	glPointSize(5);
 	glColor3f(0.0f, 0.0f, 0.0f);
-	glVertexPointer(2, GL_DOUBLE, 0, &hull_points[0]);
-	glDrawArrays(GL_POINTS,0,(GLsizei)hull_points.size()/2);
-	glDisableClientState(GL_VERTEX_ARRAY);
+	hull_point_buffer.draw(GL_POINTS);
 }
 
 void Canvas::render_segments()
 {
-	glEnableClientState(GL_VERTEX_ARRAY);
 	// blue segments
-	if (!blue_endpoints.empty())
-	{
-		glColor3ub(140, 170, 255);
-		glVertexPointer(2, GL_DOUBLE, 0, &blue_endpoints[0]);
-		glDrawArrays(GL_LINES,0,(GLsizei)blue_endpoints.size()/2);
-	}
+	blue_buffer.sync(blue_endpoints, input_generation);
+	glColor3ub(140, 170, 255);
+	blue_buffer.draw(GL_LINES);
 
 	// red segments	
-	if (!red_endpoints.empty())
-	{
-		glColor3ub(255, 170, 140);
-		glVertexPointer(2, GL_DOUBLE, 0, &red_endpoints[0]);
-		glDrawArrays(GL_LINES,0,(GLsizei)red_endpoints.size()/2);
-	}
-	glDisableClientState(GL_VERTEX_ARRAY);
+	red_buffer.sync(red_endpoints, input_generation);
+	glColor3ub(255, 170, 140);
+	red_buffer.draw(GL_LINES);
 
 	// new segment
 	if (drawing_segment)
@@ -551,10 +599,8 @@ void Canvas::render_segments()
 			glColor3ub(255, 170, 140);
 		else
 			glColor3ub(140, 170, 255);
-		glBegin(GL_LINES);
-		glVertex2d(new_segment.left.x, new_segment.left.y);
-		glVertex2d(mouse_x,mouse_y);
-		glEnd();
+		float line[] = { (float)new_segment.left.x, (float)new_segment.left.y, (float)mouse_x, (float)mouse_y };
+		draw_vertices(GL_LINES, line, 2);
 	}
 }
 
@@ -568,32 +614,69 @@ void Canvas::render_guideline()
 	glEnable(GL_LINE_STIPPLE);
 	glColor3ub(200, 200, 200);
 	glLineStipple(2,0xcccc);
-	glBegin(GL_LINES);
-		glVertex2d(0.0,mouse_y);
-		glVertex2d(w  ,mouse_y);
-		glVertex2d(mouse_x,  h);
-		glVertex2d(mouse_x,0.0);
-	glEnd();
+	double right = pan_x + w / zoom;
+	double top = pan_y + h / zoom;
+	float lines[] = { (float)pan_x, (float)mouse_y, (float)right, (float)mouse_y,
+		(float)mouse_x, (float)top, (float)mouse_x, (float)pan_y };
+	draw_vertices(GL_LINES, lines, 4);
 	glDisable(GL_LINE_STIPPLE);
 }
 
+// draws the part of a result array in view, dense parts as tiles in the same color
+void Canvas::render_results(ViewIndex & index, VertexBuffer & buffer, const std::vector<double> & array, GLenum mode, double pad_pixels)
+{
+	// primitives closer than their drawn size look the same as a tile over them
+	double tile = std::max(TILE_PIXELS, 2 * pad_pixels) / zoom;
+	index.sync(array);
+	index.query(array, pan_x, pan_y, pan_x + win_width / zoom, pan_y + win_height / zoom, tile, pad_pixels / zoom);
+
+	// the array only grows during a run, every frame uploads just what it added
+	buffer.sync(array);
+	buffer.draw(mode, index.visible());
+
+	const std::vector<float> & tiles = index.tiles();
+	if (!tiles.empty())
+		draw_vertices(GL_QUADS, &tiles[0], (unsigned)tiles.size() / 2);
+}
+
+// the rate of the timer intervals the steps used to be made at
+double Canvas::steps_per_second() const
+{
+	if (current_mode == TRAPEZOID)
+		return playback_speed * 1000 / 500;
+	if (current_mode == QUICKHULL)
+		return playback_speed * 1000 / 700;
+	return playback_speed * 1000 / 300;
+}
+
 void Canvas::trapezoid_sweep()
 {
-	trapezoid = TrapezoidSweep(blue_endpoints, red_endpoints);
-	//trapezoid.sweep();
-	timer.Start(500);
+	intersection_index.reset();
+	intersection_buffer.reset();
+	wall_index.reset();
+	wall_buffer.reset();
+	finished_index.reset();
+	finished_buffer.reset();
+	intersections.clear();
+	finished_corners.clear();
+	wall_corners.clear();
+	worker.start(TRAPEZOID, blue_endpoints, red_endpoints, hull_points);
 }
 
 void Canvas::quick_hull()
 {
-	quickhull = QuickHull(hull_points);
-	timer.Start(700);
+	quickhull_processed_index.reset();
+	quickhull_processed_buffer.reset();
+	processed.clear();
+	worker.start(QUICKHULL, blue_endpoints, red_endpoints, hull_points);
 }
 
 void Canvas::gift_wrapping_hull()
 {
-	gift = GiftWrappingHull(hull_points);
-	timer.Start(300);
+	gift_processed_index.reset();
+	gift_processed_buffer.reset();
+	processed.clear();
+	worker.start(GIFT, blue_endpoints, red_endpoints, hull_points);
 }
 
 void Canvas::save_new_segment()
@@ -612,6 +695,6 @@ void Canvas::save_new_segment()
 		blue_endpoints.push_back(new_segment.right.x);
 		blue_endpoints.push_back(new_segment.right.y);
 	}
-	std::cout << "New " << ((new_segment.color == RED) ? "red" : "blue")
-			  << " segment " << new_segment << "." << std::endl;
+	LOG(LOG_LEVEL_INFO, "New " << ((new_segment.color == RED) ? "red" : "blue")
+			  << " segment " << new_segment << ".");
 }
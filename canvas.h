@@ -3,19 +3,26 @@
 
 #include <wx/glcanvas.h>
 #include <vector>
+#include <memory>
+#include <chrono>
 
-#include "trapezoid_sweep.h"
-#include "quickhull.h"
-#include "gift_wrapping_hull.h"
+#include "gl_buffer.h"
+#include "view_index.h"
+#include "frame.h"
+#include "step_worker.h"
 
 const short int TIMER_ID = 301;
 
-enum mode
-{
-	TRAPEZOID,
-	QUICKHULL,
-	GIFT
-};
+// ms between frames taken from the worker
+const int PLAYBACK_TICK = 20;
+
+// pixels per plane unit
+const double MIN_ZOOM = 1.0 / 64;
+const double MAX_ZOOM = 64;
+const double ZOOM_STEP = 1.25;
+
+// results with one primitive per tile of this many pixels or more are drawn as tiles
+const double TILE_PIXELS = 1;
 
 class Canvas: public wxGLCanvas
 {
@@ -28,6 +35,14 @@ public:
 	void start();
 	void switch_color();
 
+	// playback speed is doubled or halved, fast forward shows the newest step on every tick
+	void faster();
+	void slower();
+	void toggle_fast_forward();
+
+	// the wheel zooms around the cursor, dragging with the middle button pans
+	void reset_view();
+
 protected:
 	void render();
 	void on_resize(wxSizeEvent&);
@@ -36,19 +51,58 @@ protected:
 	void mouse_left_click(wxMouseEvent&);
 	void mouse_left_window(wxMouseEvent&);
 	void mouse_endered_window(wxMouseEvent&);
+	void mouse_wheel(wxMouseEvent&);
 	void on_key_pressed(wxKeyEvent& event) {}
 	void on_paint(wxPaintEvent& WXUNUSED(event)) { render(); }
 	void on_erase_background(wxEraseEvent& WXUNUSED(event)){}	
-	void on_idle(wxIdleEvent & event) {}
+	void on_idle(wxIdleEvent & event);
 
 private:		
 	std::vector<double> red_endpoints;
 	std::vector<double> blue_endpoints;
 	std::vector<double> hull_points;
 
-	TrapezoidSweep trapezoid;
-	QuickHull quickhull;
-	GiftWrappingHull gift;
+	// algorithms run on the worker, the canvas draws the newest frame it took
+	StepWorker worker;
+	std::shared_ptr<const frame> shown;
+	double playback_speed;		// 1 = the original timer intervals
+	double due_steps;		// steps owed to the playback rate, a fraction of a step is carried over
+	std::chrono::steady_clock::time_point last_tick;
+
+	// input mirrored in vertex buffers, only new vertices are uploaded
+	unsigned input_generation;	// bumped whenever the input arrays are rebuilt
+	VertexBuffer red_buffer;
+	VertexBuffer blue_buffer;
+	VertexBuffer hull_point_buffer;
+
+	// results can get much larger, they are uploaded like the input and only the part in view is drawn
+	ViewIndex intersection_index;
+	ViewIndex wall_index;
+	ViewIndex finished_index;
+	ViewIndex quickhull_processed_index;
+	ViewIndex gift_processed_index;
+	VertexBuffer intersection_buffer;
+	VertexBuffer wall_buffer;
+	VertexBuffer finished_buffer;
+	VertexBuffer quickhull_processed_buffer;
+	VertexBuffer gift_processed_buffer;
+
+	// what the shown frame is working on, uploaded once per frame
+	unsigned frame_generation;	// bumped whenever a new frame is shown
+	VertexBuffer hull_buffer;
+	VertexBuffer current_buffer;	// current trapezoids or QuickHull points
+	VertexBuffer current_wall_buffer;
+
+	// histories of the run, frames carry only what they added to them
+	std::vector<double> intersections;
+	std::vector<double> processed;
+
+	/* trapezoid corners and walls expanded so far: finished trapezoids only get
+	   added, the walls and corners of the current ones are redone every frame */
+	std::vector<double> finished_corners;
+	std::vector<double> wall_corners;
+	std::vector<double> current_corners;
+	std::vector<double> current_walls;
 
 	wxTimer timer;	
 	segment new_segment;
@@ -60,21 +114,29 @@ private:
 	bool drawing_segment;
 	bool display_guideline;
 	bool display_solution;
-	double mouse_x;
+	double mouse_x;		// in the plane
 	double mouse_y;
+	int screen_x;		// in the window, for panning
+	int screen_y;
 	int win_width;
 	int win_height;
+	double zoom;
+	double pan_x;		// plane point at the bottom left corner of the window
+	double pan_y;
 
 	void init_gl();
 	void new_preview() { Refresh(); }
 	void set_projection_matrix();
 	void set_modelview_matrix();
-	void render_trapezoid_sweep();
-	void render_gift_hull();
-	void render_quickhull();
+	void keep_histories(const frame &);
+	void render_trapezoid_sweep(const frame &);
+	void render_gift_hull(const frame &);
+	void render_quickhull(const frame &);
 	void render_hull_points();
 	void render_segments();
 	void render_guideline();
+	void render_results(ViewIndex &, VertexBuffer &, const std::vector<double> &, GLenum, double pad_pixels);
+	double steps_per_second() const;
 	void trapezoid_sweep();
 	void quick_hull();
 	void gift_wrapping_hull();
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include "chan_hull.h"
+#include "monotone_chain_hull.h"
+
+ChanHull::ChanHull(const std::vector<double> & coordinates, unsigned hull_size_hint)
+{
+	std::vector<point> points;
+	points.reserve(coordinates.size() / 2);
+	for (unsigned i = 0; i + 1 < coordinates.size(); i += 2)
+		points.push_back(point(coordinates[i], coordinates[i+1]));
+
+	if (points.empty())
+		return;
+
+	std::vector<point> upper;
+	upper_hull(points, hull_size_hint, upper);
+
+	// the lower hull is the upper hull of the points turned by 180 degrees
+	for (unsigned i = 0; i < points.size(); i++)
+		points[i] = point(-points[i].x, -points[i].y);
+	std::vector<point> lower;
+	upper_hull(points, hull_size_hint, lower);
+
+	// lower hull runs from the largest point back to the smallest one
+	convex_hull = upper;
+	for (unsigned i = 1; i + 1 < lower.size(); i++)
+		convex_hull.push_back(point(-lower[i].x, -lower[i].y));
+}
+
+std::vector<double> ChanHull::get_convex_hull() const
+{
+	std::vector<double> hull;
+	hull.reserve(2*convex_hull.size());
+	for (unsigned i = 0; i < convex_hull.size(); i++)
+	{
+		hull.push_back(convex_hull[i].x);
+		hull.push_back(convex_hull[i].y);
+	}
+	return hull;
+}
+
+// squares the guess m until the march finishes within m steps
+void ChanHull::upper_hull(std::vector<point> & points, unsigned hint, std::vector<point> & hull)
+{
+	unsigned long long n = points.size();
+	unsigned long long m = hint > 4 ? hint : 4;
+	for (;;)
+	{
+		if (m > n)
+			m = n;
+		if (march(points, (unsigned)m, hull))
+			return;
+		m = m * m;
+	}
+}
+
+bool ChanHull::march(std::vector<point> & points, unsigned m, std::vector<point> & hull)
+{
+	unsigned n = (unsigned)points.size();
+
+	// upper chains of groups of m points, O(n log m)
+	chains.resize(n);
+	groups.clear();
+	for (unsigned begin = 0; begin < n; begin += m)
+	{
+		unsigned end = n - begin > m ? begin + m : n;
+		std::sort(points.begin() + begin, points.begin() + end);
+
+		group g;
+		g.begin = begin;
+		g.end = begin + upper_chain(&points[begin], end - begin, &chains[begin]);
+		groups.push_back(g);
+	}
+
+	point smallest = chains[groups[0].begin];
+	point largest = chains[groups[0].end - 1];
+	for (unsigned i = 1; i < groups.size(); i++)
+	{
+		if (chains[groups[i].begin] < smallest)
+			smallest = chains[groups[i].begin];
+		if (chains[groups[i].end - 1] > largest)
+			largest = chains[groups[i].end - 1];
+	}
+
+	// Jarvis march over the group tangents, at most m steps of O(n/m log m)
+	hull.clear();
+	point p = smallest;
+	hull.push_back(p);
+	for (unsigned step = 0; p != largest; step++)
+	{
+		if (step == m)
+			return false;
+
+		point best;
+		bool found = false;
+		for (unsigned i = 0; i < groups.size(); i++)
+		{
+			point q;
+			if (!tangent(groups[i], p, q))
+				continue;
+
+			// the most counter-clockwise candidate, the farthest one if collinear
+			double turn = found ? cross(p, best, q) : 1.0;
+			if (turn > 0 || (turn == 0 && (q.x-p.x)*(q.x-p.x) + (q.y-p.y)*(q.y-p.y) >
+				(best.x-p.x)*(best.x-p.x) + (best.y-p.y)*(best.y-p.y)))
+			{
+				best = q;
+				found = true;
+			}
+		}
+
+		p = best;
+		hull.push_back(p);
+	}
+	return true;
+}
+
+/* on the part of a concave chain to the right of P the chain first turns
+   left around P and then right, the turning point is the tangent */
+bool ChanHull::tangent(const group & g, point p, point & q) const
+{
+	const point * chain = &chains[g.begin];
+	unsigned size = g.end - g.begin;
+
+	unsigned lo = (unsigned)(std::upper_bound(chain, chain + size, p) - chain);
+	if (lo == size)
+		return false;
+
+	unsigned hi = size - 1;
+	while (lo < hi)
+	{
+		unsigned mid = (lo + hi) / 2;
+		if (cross(p, chain[mid], chain[mid+1]) >= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	q = chain[lo];
+	return true;
+}
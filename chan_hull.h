@@ -0,0 +1,40 @@
+#ifndef CHAN_HULL_H_
+#define CHAN_HULL_H_
+
+#include <vector>
+#include "point.h"
+
+/* Chan's output-sensitive algorithm, O(n log h); hull points are returned
+   in the same order as MonotoneChainHull */
+class ChanHull
+{
+public:
+	ChanHull(){}
+	// the group size starts at the expected number of hull points if one is given
+	ChanHull(const std::vector<double> &, unsigned hull_size_hint = 0);
+
+	std::vector<double> get_convex_hull() const;
+
+private:
+	std::vector<point> convex_hull;
+
+	struct group
+	{
+		unsigned begin;		// upper chain of the group in chains[begin, end)
+		unsigned end;
+	};
+
+	std::vector<point> chains;
+	std::vector<group> groups;
+
+	// upper hull of points from the smallest to the largest one
+	void upper_hull(std::vector<point> &, unsigned, std::vector<point> &);
+
+	// upper hull with at most m points using groups of m points, false if it has more
+	bool march(std::vector<point> &, unsigned, std::vector<point> &);
+
+	// point of the group chain that is the next upper hull point after P
+	bool tangent(const group &, point, point &) const;
+};
+
+#endif
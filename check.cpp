@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "point.h"
+#include "thread_pool.h"
+#include "trapezoid_sweep.h"
+
+/* checks that the sweep gives the same answer however the work is split:
+     trapezoid_check
+   exits with 1 if some case differs */
+
+namespace
+{
+	typedef std::vector<double> segments;
+
+	const double LOW = -10, HIGH = 10;
+	const unsigned SPLITS[] = { 1, 2, 4, 5, 10, 20 };
+
+	// crossing points sorted, so tiles may report them in any order
+	std::vector<point> sorted_points(const std::vector<double> & xy)
+	{
+		std::vector<point> p;
+		for (size_t i = 0; i + 1 < xy.size(); i += 2)
+			p.push_back(point(xy[i], xy[i + 1]));
+		std::sort(p.begin(), p.end());
+		return p;
+	}
+
+	// segments of one color must not meet each other
+	bool fits(const segments & layer, const double * s)
+	{
+		point at;
+		for (size_t k = 0; k < layer.size(); k += 4)
+			if (meet(point(s[0], s[1]), point(s[2], s[3]), point(layer[k], layer[k + 1]),
+				point(layer[k + 2], layer[k + 3]), at))
+				return false;
+		return true;
+	}
+
+	double eighths() { return (rand() % 64 - 32) / 8.0; }
+	double anywhere() { return LOW + (HIGH - LOW) * rand() / RAND_MAX; }
+
+	/* red and blue pairs crossing on tile edges, x or y on the integers every grid
+	   of SPLITS cuts at, with dyadic directions so the crossing is exact; general
+	   segments in between */
+	void edge_crossings(unsigned seed, segments & blue, segments & red)
+	{
+		srand(seed);
+		unsigned n = 5 + seed % 20;
+		for (unsigned i = 0; i < n; i++)
+		{
+			double px = rand() % 19 - 9, py = rand() % 19 - 9;
+			if (rand() % 3 == 0)
+				px += eighths() / 8;
+			else if (rand() % 2)
+				py += eighths() / 8;
+			double dx = eighths(), dy = eighths(), ex = eighths(), ey = eighths();
+			double t[4];
+			for (unsigned k = 0; k < 4; k++)
+				t[k] = (1 + rand() % 8) / 8.0;
+			double r[] = { px - t[0] * dx, py - t[0] * dy, px + t[1] * dx, py + t[1] * dy };
+			double b[] = { px - t[2] * ex, py - t[2] * ey, px + t[3] * ex, py + t[3] * ey };
+			if (dx * ey != dy * ex && fits(red, r) && fits(blue, b))
+			{
+				red.insert(red.end(), r, r + 4);
+				blue.insert(blue.end(), b, b + 4);
+			}
+
+			double rr[] = { anywhere(), anywhere(), anywhere(), anywhere() };
+			double bb[] = { anywhere(), anywhere(), anywhere(), anywhere() };
+			if (fits(red, rr))
+				red.insert(red.end(), rr, rr + 4);
+			if (fits(blue, bb))
+				blue.insert(blue.end(), bb, bb + 4);
+		}
+	}
+
+	// tiled_intersections() over [LOW,HIGH) against the full sweep cut to the same square
+	bool same_tiled(const segments & blue, const segments & red, unsigned columns, unsigned rows,
+		ThreadPool & pool)
+	{
+		TrapezoidSweep full(blue, red);
+		full.sweep();
+		const std::vector<double> & all = full.intersections();
+		std::vector<double> inside;
+		for (size_t i = 0; i + 1 < all.size(); i += 2)
+		{
+			if (all[i] >= LOW && all[i] < HIGH && all[i + 1] >= LOW && all[i + 1] < HIGH)
+			{
+				inside.push_back(all[i]);
+				inside.push_back(all[i + 1]);
+			}
+		}
+		std::vector<double> tiled = TrapezoidSweep::tiled_intersections(blue, red, LOW, LOW, HIGH, HIGH,
+			columns, rows, pool);
+		return sorted_points(inside) == sorted_points(tiled);
+	}
+}
+
+int main()
+{
+	ThreadPool pool;
+	unsigned cases = 0, failed = 0;
+
+	// crossings at (0,0) and (1,1), the first on the left edge of a tile
+	double b[] = { -10, 0, 10, 0, -10, 1, 10, 1 };
+	double r[] = { -5, -5, 5, 5 };
+	segments blue(b, b + 8), red(r, r + 4);
+	for (unsigned k = 0; k < 2; k++, cases++)
+	{
+		unsigned split = k == 0 ? 2 : 20;
+		if (!same_tiled(blue, red, split, k == 0 ? 1 : split, pool))
+		{
+			std::cerr << "edge crossings: " << split << " columns differ from the full sweep" << std::endl;
+			failed++;
+		}
+	}
+
+	for (unsigned seed = 0; seed < 300; seed++, cases++)
+	{
+		segments blue, red;
+		edge_crossings(seed, blue, red);
+		unsigned columns = SPLITS[seed % 6], rows = SPLITS[seed / 6 % 6];
+		if (!same_tiled(blue, red, columns, rows, pool))
+		{
+			std::cerr << "seed " << seed << ": " << columns << "x" << rows
+				<< " tiles differ from the full sweep" << std::endl;
+			failed++;
+		}
+	}
+
+	std::cout << failed << " of " << cases << " cases failed" << std::endl;
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,84 @@
+#include <fstream>
+
+#include "chunked_hull.h"
+#include "hull_engine.h"
+#include "monotone_chain_hull.h"
+#include "log.h"
+
+ChunkedHull::ChunkedHull(std::istream & in, ThreadPool & pool, unsigned chunk_points)
+	: read_ok(false), input_flags(INPUT_OK), points_read(0)
+{
+	build(in, pool, chunk_points);
+}
+
+ChunkedHull::ChunkedHull(const char * path, ThreadPool & pool, unsigned chunk_points)
+	: read_ok(false), input_flags(INPUT_OK), points_read(0)
+{
+	std::ifstream in(path, std::ios::binary);
+	if (in.is_open())
+		build(in, pool, chunk_points);
+}
+
+/* every thread of the pool owns a slot with a chunk buffer; a slot is
+   refilled once the hull of its previous chunk has been merged */
+void ChunkedHull::build(std::istream & in, ThreadPool & pool, unsigned chunk_points)
+{
+	if (chunk_points < 4)
+		chunk_points = 4;
+
+	unsigned slots = pool.size();
+	std::vector<std::vector<double> > chunks(slots);
+	std::vector<std::vector<double> > hulls(slots);
+	std::vector<TaskGroup> groups(slots);
+
+	// the merged chunk hulls are reduced to their hull whenever they outgrow the limit
+	std::vector<double> merged;
+	size_t limit = chunk_points;
+	for (unsigned slot = 0; ; slot = (slot + 1) % slots)
+	{
+		pool.wait(groups[slot]);
+		merged.insert(merged.end(), hulls[slot].begin(), hulls[slot].end());
+		hulls[slot].clear();
+		if (merged.size() / 2 > limit)
+		{
+			merged = MonotoneChainHull(merged).get_convex_hull();
+			if (merged.size() / 2 > limit)
+				limit = merged.size() / 2;
+		}
+
+		if (!in)
+			break;
+
+		std::vector<double> & chunk = chunks[slot];
+		chunk.resize(2 * (size_t)chunk_points);
+		in.read((char *)chunk.data(), chunk.size() * sizeof(double));
+		size_t bytes = (size_t)in.gcount();
+		chunk.resize(bytes / (2 * sizeof(double)) * 2);
+
+		// only the last read can end inside a pair
+		if (bytes % (2 * sizeof(double)) != 0)
+		{
+			input_flags |= INPUT_TRAILING;
+			LOG(LOG_LEVEL_WARNING, "Ignored " << bytes % (2 * sizeof(double)) << " bytes after the last whole point.");
+		}
+		points_read += chunk.size() / 2;
+		if (chunk.empty())
+			continue;
+
+		std::vector<double> & hull = hulls[slot];
+		pool.run(groups[slot], [&chunk, &hull]()
+		{
+			hull = compute_convex_hull(chunk, 0, true);
+		});
+	}
+
+	// chunks still being processed when the stream ended
+	for (unsigned slot = 0; slot < slots; slot++)
+	{
+		pool.wait(groups[slot]);
+		merged.insert(merged.end(), hulls[slot].begin(), hulls[slot].end());
+	}
+
+	convex_hull = MonotoneChainHull(merged).get_convex_hull();
+	read_ok = in.eof() && !in.bad();
+}
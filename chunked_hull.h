@@ -0,0 +1,43 @@
+#ifndef CHUNKED_HULL_H_
+#define CHUNKED_HULL_H_
+
+#include <vector>
+#include <istream>
+
+#include "thread_pool.h"
+#include "bulk_input.h"
+
+// points read at once from the stream, 16 MB of coordinates
+const unsigned CHUNK_POINTS = 1 << 20;
+
+/* hull of a point set that does not fit in memory: the points are read as
+   binary x,y double pairs in chunks, the hull of every chunk is computed on
+   the pool while the next chunks are read, chunk hulls are merged as they
+   come; memory is bounded by one chunk per thread plus the hull points,
+   the hull is returned in the same order as MonotoneChainHull */
+class ChunkedHull
+{
+public:
+	ChunkedHull() : read_ok(false), input_flags(INPUT_OK), points_read(0) {}
+	ChunkedHull(std::istream &, ThreadPool &, unsigned chunk_points = CHUNK_POINTS);
+	ChunkedHull(const char * path, ThreadPool &, unsigned chunk_points = CHUNK_POINTS);
+
+	// false if the file could not be opened or reading failed before its end
+	bool good() const { return read_ok; }
+	unsigned long long size() const { return points_read; }
+
+	// INPUT_TRAILING if the stream ended inside an x,y pair, which is ignored
+	unsigned input_errors() const { return input_flags; }
+
+	std::vector<double> get_convex_hull() const { return convex_hull; }
+
+private:
+	std::vector<double> convex_hull;
+	bool read_ok;
+	unsigned input_flags;
+	unsigned long long points_read;
+
+	void build(std::istream &, ThreadPool &, unsigned);
+};
+
+#endif
@@ -0,0 +1,134 @@
+#include "dynamic_hull.h"
+#include "monotone_chain_hull.h"
+
+DynamicHull::DynamicHull(const std::vector<double> & coordinates)
+{
+	insert(coordinates);
+}
+
+DynamicHull::DynamicHull(const QuickHull & quickhull)
+{
+	std::vector<double> hull = quickhull.get_convex_hull();
+	for (unsigned i = 0; i + 1 < hull.size(); i += 2)
+		insert(point(hull[i], hull[i+1]));
+}
+
+void DynamicHull::insert(point p)
+{
+	insert(upper, p);
+	insert(lower, point(p.x, -p.y));
+}
+
+void DynamicHull::insert(const std::vector<double> & coordinates)
+{
+	std::vector<double> hull = MonotoneChainHull(coordinates).get_convex_hull();
+	for (unsigned i = 0; i + 1 < hull.size(); i += 2)
+		insert(point(hull[i], hull[i+1]));
+}
+
+bool DynamicHull::contains(point p) const
+{
+	return below(upper, p) && below(lower, point(p.x, -p.y));
+}
+
+void DynamicHull::clear()
+{
+	upper.clear();
+	lower.clear();
+}
+
+/* lower chain from the left, upper chain, lower chain from the right,
+   the ends are left out where both chains share them */
+std::vector<double> DynamicHull::get_convex_hull() const
+{
+	std::vector<double> hull;
+	if (upper.empty())
+		return hull;
+
+	point first = point(lower.begin()->first, -lower.begin()->second);
+	hull.push_back(first.x);
+	hull.push_back(first.y);
+
+	for (chain::const_iterator i = upper.begin(); i != upper.end(); ++i)
+	{
+		if (i == upper.begin() && i->second == first.y)
+			continue;
+		hull.push_back(i->first);
+		hull.push_back(i->second);
+	}
+
+	chain::const_reverse_iterator last = upper.rbegin();
+	for (chain::const_reverse_iterator i = lower.rbegin(); i != lower.rend(); ++i)
+	{
+		if (i == lower.rbegin() && -i->second == last->second)
+			continue;
+		if (i->first == first.x)
+			break;
+		hull.push_back(i->first);
+		hull.push_back(-i->second);
+	}
+	return hull;
+}
+
+/* points of the chain that are no longer on it after P is added are removed,
+   each point is removed at most once, so the insertion is amortized O(log n) */
+void DynamicHull::insert(chain & c, point p)
+{
+	chain::iterator next = c.lower_bound(p.x);
+	if (next != c.end() && next->first == p.x)
+	{
+		if (next->second >= p.y)
+			return;
+		next = c.erase(next);
+	}
+	else if (next != c.end() && next != c.begin())
+	{
+		chain::iterator prev = next;
+		--prev;
+		if (cross(point(prev->first, prev->second), point(next->first, next->second), p) <= 0)
+			return;
+	}
+
+	// neighbours on the right that are not a right turn any more
+	while (next != c.end())
+	{
+		chain::iterator after = next;
+		++after;
+		if (after == c.end() ||
+			cross(p, point(next->first, next->second), point(after->first, after->second)) < 0)
+			break;
+		next = c.erase(next);
+	}
+
+	// neighbours on the left
+	while (next != c.begin())
+	{
+		chain::iterator prev = next;
+		--prev;
+		if (prev == c.begin())
+			break;
+		chain::iterator before = prev;
+		--before;
+		if (cross(point(before->first, before->second), point(prev->first, prev->second), p) < 0)
+			break;
+		c.erase(prev);
+	}
+
+	c.insert(next, std::make_pair(p.x, p.y));
+}
+
+// whether P is not above the chain
+bool DynamicHull::below(const chain & c, point p)
+{
+	chain::const_iterator next = c.lower_bound(p.x);
+	if (next == c.end())
+		return false;
+	if (next->first == p.x)
+		return p.y <= next->second;
+	if (next == c.begin())
+		return false;
+
+	chain::const_iterator prev = next;
+	--prev;
+	return cross(point(prev->first, prev->second), point(next->first, next->second), p) <= 0;
+}
@@ -0,0 +1,47 @@
+#ifndef DYNAMIC_HULL_H_
+#define DYNAMIC_HULL_H_
+
+#include <vector>
+#include <map>
+
+#include "point.h"
+#include "quickhull.h"
+
+/* online hull for points arriving over time: the upper and the lower chain
+   are kept sorted by x, a point is inserted in amortized O(log n) and
+   the hull can be read at any time in the same order as MonotoneChainHull */
+class DynamicHull
+{
+public:
+	DynamicHull(){}
+	DynamicHull(const std::vector<double> &);
+
+	// starts from an already computed hull, O(h log h)
+	DynamicHull(const QuickHull &);
+
+	void insert(point);
+
+	// the hull of the batch is computed first, only its points are inserted
+	void insert(const std::vector<double> &);
+
+	// whether p lies inside or on the border of the hull, O(log n)
+	bool contains(point) const;
+
+	bool empty() const { return upper.empty(); }
+	void clear();
+
+	std::vector<double> get_convex_hull() const;
+
+private:
+	/* x -> y of the chain points, the lower chain is stored mirrored (x -> -y)
+	   so both are upper chains and share the same code */
+	typedef std::map<double, double> chain;
+
+	chain upper;
+	chain lower;
+
+	static void insert(chain &, point);
+	static bool below(const chain &, point);
+};
+
+#endif
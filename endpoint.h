@@ -6,9 +6,10 @@
 
 const double infinity = std::numeric_limits<double>::infinity();
 
+// INNER is a vertex inside a chain of polyline edges, where one edge ends and the next starts
 enum endpoint_type
 {
-	LEFT, RIGHT
+	LEFT, RIGHT, INNER
 };
 
 struct endpoint
@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <queue>
+#include <utility>
+
+#include "external_sweep.h"
+#include "bulk_input.h"
+#include "log.h"
+
+namespace
+{
+	// runs merged in one pass, each needs a read block in memory
+	const unsigned MERGE_WAYS = 64;
+
+	// events read from or written to a run at a time
+	const unsigned EVENT_BLOCK = 4096;
+
+	// segments read from an input at a time
+	const unsigned INPUT_BLOCK = 1 << 16;
+
+	// intersections kept before they are written out
+	const unsigned PAIR_BLOCK = 1 << 16;
+}
+
+bool ExternalSweep::event_order::operator () (const event & a, const event & b) const
+{
+	if (a.x != b.x)
+		return a.x < b.x;
+	if (a.y != b.y)
+		return a.y < b.y;
+
+	// segments ending at a point leave the sweep line before the ones starting there
+	if (a.type != b.type)
+		return a.type == RIGHT;
+	if (a.color != b.color)
+		return a.color < b.color;
+	return a.id < b.id;
+}
+
+ExternalSweep::ExternalSweep(const std::string & blue_path, const std::string & red_path,
+	const std::string & pairs_path, const std::string & temp_prefix, unsigned run_events)
+	: ok(true), input_flags(INPUT_OK), event_count(0), pair_count(0), run_count(0), peak(0),
+	temp_prefix(temp_prefix), temp_files(0)
+{
+	// a segment puts both its endpoints into the same run
+	if (run_events < 2)
+		run_events = 2;
+
+	std::vector<event> buffer;
+	buffer.reserve(run_events);
+	make_runs(blue_path, BLUE, buffer, run_events);
+	make_runs(red_path, RED, buffer, run_events);
+	if (ok && !buffer.empty())
+		write_run(buffer);
+	std::vector<event>().swap(buffer);
+	run_count = (unsigned)run_paths.size();
+
+	TrapezoidSweep sweep;
+	std::vector<double> none;
+	BulkInput empty(none, 4);
+	sweep.init(empty, empty, false, 0);
+	sweep.keep_trapezoids = false;
+
+	// merge groups of runs until the rest can be merged straight into the sweep
+	while (ok && run_paths.size() > MERGE_WAYS)
+	{
+		std::vector<std::string> merged;
+		for (size_t first = 0; ok && first < run_paths.size(); first += MERGE_WAYS)
+		{
+			size_t last = std::min(first + MERGE_WAYS, run_paths.size());
+			std::vector<std::string> group(run_paths.begin() + first, run_paths.begin() + last);
+			std::string path = temp_path();
+			FILE * out = fopen(path.c_str(), "wb");
+			if (!out)
+			{
+				LOG(LOG_LEVEL_ERROR, "Cannot write " << path << ".");
+				ok = false;
+				break;
+			}
+			merge(group, out, sweep, 0);
+			if (fclose(out) != 0)
+				ok = false;
+			merged.push_back(path);
+		}
+		if (ok)
+			run_paths.swap(merged);
+		else
+			run_paths.insert(run_paths.end(), merged.begin(), merged.end());
+	}
+
+	FILE * pairs = ok ? fopen(pairs_path.c_str(), "wb") : 0;
+	if (ok && !pairs)
+	{
+		LOG(LOG_LEVEL_ERROR, "Cannot write " << pairs_path << ".");
+		ok = false;
+	}
+	if (ok)
+	{
+		merge(run_paths, 0, sweep, pairs);
+		write_pairs(sweep, pairs);
+		if (fclose(pairs) != 0)
+			ok = false;
+	}
+
+	// left over by a failure
+	for (size_t i = 0; i < run_paths.size(); i++)
+		remove(run_paths[i].c_str());
+	run_paths.clear();
+	for (std::unordered_map<unsigned long long, segment *>::iterator it = active.begin(); it != active.end(); ++it)
+		delete it->second;
+	active.clear();
+}
+
+std::string ExternalSweep::temp_path()
+{
+	return temp_prefix + std::to_string(temp_files++);
+}
+
+void ExternalSweep::make_runs(const std::string & path, segment_color color, std::vector<event> & buffer,
+	unsigned run_events)
+{
+	FILE * in = fopen(path.c_str(), "rb");
+	if (!in)
+	{
+		LOG(LOG_LEVEL_ERROR, "Cannot read " << path << ".");
+		ok = false;
+		return;
+	}
+
+	std::vector<double> values;
+	unsigned base = 0;		// id of the first segment of the block
+	while (ok)
+	{
+		values.resize(4 * (size_t)INPUT_BLOCK);
+		size_t got = fread(&values[0], sizeof(double), values.size(), in);
+		if (got == 0)
+			break;
+		values.resize(got);
+
+		// the same checks and endpoint rules as TrapezoidSweep::init_queue() and add_segment()
+		BulkInput input(values, 4);
+		input_flags |= input.errors();
+		for (unsigned i = 0; i < input.size(); i++)
+		{
+			const double * v = input.data() + 4 * (size_t)i;
+			endpoint left_point(v[0], v[1]);
+			endpoint right_point(v[2], v[3]);
+			if (right_point.x == left_point.x)
+				left_point.x += 0.0000001;
+			if (left_point > right_point)
+				std::swap(left_point, right_point);
+
+			event e;
+			e.id = base + input.origin(i);
+			e.color = (unsigned char)color;
+
+			e.x = left_point.x;
+			e.y = left_point.y;
+			e.other_x = right_point.x;
+			e.other_y = right_point.y;
+			e.type = LEFT;
+			buffer.push_back(e);
+
+			e.x = right_point.x;
+			e.y = right_point.y;
+			e.other_x = left_point.x;
+			e.other_y = left_point.y;
+			e.type = RIGHT;
+			buffer.push_back(e);
+
+			if (buffer.size() + 2 > run_events)
+				write_run(buffer);
+		}
+		base += input.input_size();
+	}
+
+	if (ferror(in))
+	{
+		LOG(LOG_LEVEL_ERROR, "Cannot read " << path << ".");
+		ok = false;
+	}
+	fclose(in);
+}
+
+void ExternalSweep::write_run(std::vector<event> & buffer)
+{
+	std::sort(buffer.begin(), buffer.end(), event_order());
+
+	std::string path = temp_path();
+	FILE * out = fopen(path.c_str(), "wb");
+	if (!out || fwrite(&buffer[0], sizeof(event), buffer.size(), out) != buffer.size())
+	{
+		LOG(LOG_LEVEL_ERROR, "Cannot write " << path << ".");
+		ok = false;
+	}
+	if (out && fclose(out) != 0)
+		ok = false;
+
+	run_paths.push_back(path);
+	buffer.clear();
+}
+
+void ExternalSweep::merge(const std::vector<std::string> & paths, FILE * out, TrapezoidSweep & sweep, FILE * pairs)
+{
+	struct source
+	{
+		FILE * file;
+		std::vector<event> block;
+		size_t next, end;
+	};
+
+	// the smallest head on top
+	struct later
+	{
+		bool operator () (const std::pair<event, unsigned> & a, const std::pair<event, unsigned> & b) const
+		{
+			return event_order()(b.first, a.first);
+		}
+	};
+
+	std::vector<source> sources(paths.size());
+	std::priority_queue<std::pair<event, unsigned>, std::vector<std::pair<event, unsigned> >, later> heads;
+	for (unsigned i = 0; i < sources.size(); i++)
+	{
+		source & s = sources[i];
+		s.block.resize(EVENT_BLOCK);
+		s.next = s.end = 0;
+		s.file = fopen(paths[i].c_str(), "rb");
+		if (!s.file)
+		{
+			LOG(LOG_LEVEL_ERROR, "Cannot read " << paths[i] << ".");
+			ok = false;
+			continue;
+		}
+		s.end = fread(&s.block[0], sizeof(event), EVENT_BLOCK, s.file);
+		if (s.end > 0)
+			heads.push(std::make_pair(s.block[s.next++], i));
+	}
+
+	std::vector<event> written;
+	if (out)
+		written.reserve(EVENT_BLOCK);
+
+	while (ok && !heads.empty())
+	{
+		std::pair<event, unsigned> head = heads.top();
+		heads.pop();
+
+		if (out)
+		{
+			written.push_back(head.first);
+			if (written.size() == EVENT_BLOCK)
+			{
+				if (fwrite(&written[0], sizeof(event), written.size(), out) != written.size())
+					ok = false;
+				written.clear();
+			}
+		}
+		else
+			sweep_event(head.first, sweep, pairs);
+
+		source & s = sources[head.second];
+		if (s.next == s.end)
+		{
+			s.next = 0;
+			s.end = fread(&s.block[0], sizeof(event), EVENT_BLOCK, s.file);
+		}
+		if (s.next < s.end)
+			heads.push(std::make_pair(s.block[s.next++], head.second));
+	}
+
+	if (out && !written.empty() && fwrite(&written[0], sizeof(event), written.size(), out) != written.size())
+		ok = false;
+
+	for (unsigned i = 0; i < sources.size(); i++)
+	{
+		if (!sources[i].file)
+			continue;
+		if (ferror(sources[i].file))
+			ok = false;
+		fclose(sources[i].file);
+		remove(paths[i].c_str());
+	}
+	if (!ok)
+		LOG(LOG_LEVEL_ERROR, "Merging the sorted runs failed.");
+}
+
+void ExternalSweep::sweep_event(const event & e, TrapezoidSweep & sweep, FILE * pairs)
+{
+	unsigned long long key = 2ULL * e.id + e.color;
+	endpoint p(e.x, e.y);
+	p.type = (endpoint_type)e.type;
+
+	if (e.type == LEFT)
+	{
+		endpoint other(e.other_x, e.other_y);
+		other.type = RIGHT;
+		segment * s = new segment(p, other, (segment_color)e.color);
+		s->id = e.id;
+		active[key] = s;
+		if (active.size() > peak)
+			peak = active.size();
+		sweep.process_event(p, s);
+	}
+	else
+	{
+		std::unordered_map<unsigned long long, segment *>::iterator it = active.find(key);
+		if (it == active.end())
+			return;
+
+		// the sweep drops the segment at its right endpoint, then it is no longer needed
+		segment * s = it->second;
+		sweep.process_event(p, s);
+		active.erase(it);
+		delete s;
+	}
+	event_count++;
+
+	if (sweep.pairs.size() >= 2 * (size_t)PAIR_BLOCK)
+		write_pairs(sweep, pairs);
+}
+
+void ExternalSweep::write_pairs(TrapezoidSweep & sweep, FILE * pairs)
+{
+	if (sweep.pairs.empty())
+		return;
+	if (fwrite(&sweep.pairs[0], sizeof(unsigned), sweep.pairs.size(), pairs) != sweep.pairs.size())
+	{
+		LOG(LOG_LEVEL_ERROR, "Cannot write the intersections.");
+		ok = false;
+	}
+	pair_count += sweep.pairs.size() / 2;
+	sweep.pairs.clear();
+}
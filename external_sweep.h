@@ -0,0 +1,87 @@
+#ifndef EXTERNAL_SWEEP_H_
+#define EXTERNAL_SWEEP_H_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdio>
+
+#include "trapezoid_sweep.h"
+
+// endpoints sorted in memory at a time, 40 bytes each
+const unsigned RUN_EVENTS = 1 << 22;
+
+/* red/blue intersection of inputs that do not fit in memory: the endpoints are
+   sorted into runs on disk, the runs are merged into one stream that drives the
+   trapezoid sweep, a segment is in memory from its left to its right endpoint
+   and the intersections are written out as they are found.
+   inputs are files of raw doubles x1,y1,x2,y2 per segment, the output gets a red
+   id, blue id pair of unsigned per intersection, ids count the segments of each
+   file like TrapezoidSweep::intersecting_pairs(). memory holds one run while
+   sorting, a block per run while merging and the segments crossing the sweep line */
+class ExternalSweep
+{
+public:
+	// temporary runs are named temp_prefix followed by a number and removed when merged
+	ExternalSweep(const std::string & blue_path, const std::string & red_path,
+		const std::string & pairs_path, const std::string & temp_prefix,
+		unsigned run_events = RUN_EVENTS);
+
+	// false if a file could not be read or written, the output is then incomplete
+	bool good() const { return ok; }
+
+	// input_error flags of both inputs
+	unsigned input_errors() const { return input_flags; }
+
+	unsigned long long events() const { return event_count; }
+	unsigned long long intersections() const { return pair_count; }
+	unsigned runs() const { return run_count; }
+
+	// most segments in memory at once
+	size_t peak_status() const { return peak; }
+
+private:
+	// an endpoint with the other end of its segment, the unit of runs
+	struct event
+	{
+		double x, y;
+		double other_x, other_y;
+		unsigned id;
+		unsigned char color;
+		unsigned char type;
+	};
+
+	// endpoint order of the sweep queue, ties are broken by the rest for a fixed order
+	struct event_order
+	{
+		bool operator () (const event & a, const event & b) const;
+	};
+
+	bool ok;
+	unsigned input_flags;
+	unsigned long long event_count;
+	unsigned long long pair_count;
+	unsigned run_count;
+	size_t peak;
+
+	std::string temp_prefix;
+	unsigned temp_files;
+	std::vector<std::string> run_paths;
+
+	// segments between their left and right endpoint by 2 * id + color
+	std::unordered_map<unsigned long long, segment *> active;
+
+	void make_runs(const std::string & path, segment_color, std::vector<event> & buffer, unsigned run_events);
+	void write_run(std::vector<event> & buffer);
+	std::string temp_path();
+
+	// merges runs into out or, without out, through the sweep, and removes them
+	void merge(const std::vector<std::string> & paths, FILE * out, TrapezoidSweep & sweep, FILE * pairs);
+	void sweep_event(const event &, TrapezoidSweep &, FILE * pairs);
+	void write_pairs(TrapezoidSweep &, FILE * pairs);
+
+	ExternalSweep(const ExternalSweep &);
+	ExternalSweep & operator = (const ExternalSweep &);
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "frame.h"
+
+namespace
+{
+	template <class T>
+	void copy_after(const std::vector<T> & history, size_t from, std::vector<T> & added)
+	{
+		if (from < history.size())
+			added.assign(history.begin() + from, history.end());
+	}
+}
+
+history_mark frame::to() const
+{
+	history_mark mark = from;
+	mark.intersections += intersections.size();
+	mark.finished_trapezoids += finished_trapezoids.size();
+	mark.processed += processed.size();
+	return mark;
+}
+
+frame capture_frame(const TrapezoidSweep & trapezoid, const shared_input & blue_endpoints,
+	const shared_input & red_endpoints, unsigned step, bool finished, const history_mark & from)
+{
+	frame f;
+	f.algorithm = TRAPEZOID;
+	f.step = step;
+	f.finished = finished;
+	f.blue_segments = blue_endpoints;
+	f.red_segments = red_endpoints;
+
+	f.from = from;
+	copy_after(trapezoid.intersections(), from.intersections, f.intersections);
+	copy_after(trapezoid.finished(), from.finished_trapezoids, f.finished_trapezoids);
+	f.current_trapezoids = trapezoid.current();
+	f.trapezoid_bottom = trapezoid.trapezoid_bottom();
+	f.trapezoid_top = trapezoid.trapezoid_top();
+	f.sweep_x = trapezoid.sweepline_x();
+	f.endpoint_x = trapezoid.current_endpoint_x();
+	f.endpoint_y = trapezoid.current_endpoint_y();
+	f.endpoint_color = trapezoid.current_segment_color();
+	return f;
+}
+
+frame capture_frame(const QuickHull & quickhull, const shared_input & points, unsigned step, bool finished,
+	const history_mark & from)
+{
+	frame f;
+	f.algorithm = QUICKHULL;
+	f.step = step;
+	f.finished = finished;
+	f.points = points;
+
+	f.hull = quickhull.get_convex_hull();
+	f.from = from;
+	copy_after(quickhull.processed_lines(), from.processed, f.processed);
+	f.current_points = quickhull.current_points();
+	f.current_line = quickhull.current_line();
+	f.triangle = quickhull.processed_triangle();
+	return f;
+}
+
+frame capture_frame(const GiftWrappingHull & gift, const shared_input & points, unsigned step, bool finished,
+	const history_mark & from)
+{
+	frame f;
+	f.algorithm = GIFT;
+	f.step = step;
+	f.finished = finished;
+	f.points = points;
+
+	f.hull = gift.get_convex_hull();
+	f.from = from;
+	copy_after(gift.processed_lines(), from.processed, f.processed);
+	f.current_line = gift.current_line();
+	f.min_line = gift.min_line();
+	return f;
+}
+
+void append_histories(frame & f, const frame & next)
+{
+	f.intersections.insert(f.intersections.end(), next.intersections.begin(), next.intersections.end());
+	f.finished_trapezoids.insert(f.finished_trapezoids.end(),
+		next.finished_trapezoids.begin(), next.finished_trapezoids.end());
+	f.processed.insert(f.processed.end(), next.processed.begin(), next.processed.end());
+}
+
+Replay::Replay(mode algorithm, const shared_input & blue_endpoints, const shared_input & red_endpoints,
+	const shared_input & points)
+	: algorithm(algorithm), blue_endpoints(blue_endpoints), red_endpoints(red_endpoints), points(points)
+{
+	if (algorithm == TRAPEZOID)
+		trapezoid.reset(new TrapezoidSweep(*blue_endpoints, *red_endpoints));
+	if (algorithm == QUICKHULL)
+		quickhull = QuickHull(*points);
+	if (algorithm == GIFT)
+		gift = GiftWrappingHull(*points);
+}
+
+bool Replay::next_step()
+{
+	if (algorithm == TRAPEZOID)
+		return trapezoid->next_step();
+	if (algorithm == QUICKHULL)
+		return quickhull.next_step();
+	return gift.next_step();
+}
+
+frame Replay::capture(unsigned step, bool finished, const history_mark & from) const
+{
+	if (algorithm == TRAPEZOID)
+		return capture_frame(*trapezoid, blue_endpoints, red_endpoints, step, finished, from);
+	if (algorithm == QUICKHULL)
+		return capture_frame(quickhull, points, step, finished, from);
+	return capture_frame(gift, points, step, finished, from);
+}
@@ -0,0 +1,106 @@
+#ifndef FRAME_H_
+#define FRAME_H_
+
+#include <vector>
+#include <memory>
+
+#include "segment.h"
+#include "trapezoid_sweep.h"
+#include "quickhull.h"
+#include "gift_wrapping_hull.h"
+
+enum mode
+{
+	TRAPEZOID,
+	QUICKHULL,
+	GIFT
+};
+
+typedef std::shared_ptr<const std::vector<double> > shared_input;
+
+// lengths of the histories of an engine, which only grow during a run
+struct history_mark
+{
+	size_t intersections;		// coordinates
+	size_t finished_trapezoids;
+	size_t processed;		// coordinates
+
+	history_mark() : intersections(0), finished_trapezoids(0), processed(0) {}
+};
+
+/* everything the canvas draws for one step of an algorithm, copied out of
+   the engine, so the frame can be rendered later or by another thread;
+   the input is shared by all frames of a run, the histories hold only what
+   was added after the lengths in from, everything if from is all zero */
+struct frame
+{
+	mode algorithm;
+	unsigned step;			// number of next_step() calls made
+	bool finished;			// the last step, drawn like a stopped timer
+
+	shared_input blue_segments;	// input, x1,y1,x2,y2 per segment
+	shared_input red_segments;
+	shared_input points;		// hull input
+
+	history_mark from;		// history lengths of an earlier frame
+	history_mark to() const;	// history lengths of this frame
+
+	// trapezoid sweep
+	std::vector<double> intersections;
+	std::vector<TrapezoidSweep::trapezoid> finished_trapezoids;	// corners from blue_segments
+	std::vector<TrapezoidSweep::trapezoid> current_trapezoids;
+	double trapezoid_bottom, trapezoid_top;
+	double sweep_x;
+	double endpoint_x;		// endpoint being processed, infinity if there is none
+	double endpoint_y;
+	segment_color endpoint_color;
+
+	// hulls
+	std::vector<double> hull;		// border found so far
+	std::vector<double> processed;		// connections tested so far
+	std::vector<double> current_points;	// QuickHull points of the next step
+	std::vector<double> current_line;	// line being tested
+	std::vector<double> min_line;		// gift wrapping line to the best point so far
+	std::vector<double> triangle;		// QuickHull triangle of the last step
+
+	frame() : algorithm(TRAPEZOID), step(0), finished(false), trapezoid_bottom(0), trapezoid_top(0), sweep_x(0),
+		endpoint_x(infinity), endpoint_y(infinity), endpoint_color(BLUE) {}
+};
+
+// the histories are copied after the lengths in from
+frame capture_frame(const TrapezoidSweep &, const shared_input & blue_endpoints, const shared_input & red_endpoints,
+	unsigned step, bool finished, const history_mark & from = history_mark());
+frame capture_frame(const QuickHull &, const shared_input & points, unsigned step, bool finished,
+	const history_mark & from = history_mark());
+frame capture_frame(const GiftWrappingHull &, const shared_input & points, unsigned step, bool finished,
+	const history_mark & from = history_mark());
+
+// appends the histories of the next frame, whose from has to be the to() of the first
+void append_histories(frame &, const frame & next);
+
+// one run of the algorithm, stepped like the canvas timer does
+class Replay
+{
+public:
+	Replay(mode, const shared_input & blue_endpoints, const shared_input & red_endpoints,
+		const shared_input & points);
+
+	// true once the algorithm is finished
+	bool next_step();
+
+	frame capture(unsigned step, bool finished, const history_mark & from = history_mark()) const;
+
+private:
+	mode algorithm;
+	shared_input blue_endpoints;
+	shared_input red_endpoints;
+	shared_input points;
+	std::unique_ptr<TrapezoidSweep> trapezoid;	// not copyable, made only for its mode
+	QuickHull quickhull;
+	GiftWrappingHull gift;
+
+	Replay(const Replay &);
+	Replay & operator = (const Replay &);
+};
+
+#endif
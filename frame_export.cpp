@@ -0,0 +1,482 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include "frame_export.h"
+
+namespace
+{
+	struct color
+	{
+		unsigned char r, g, b;
+		color(unsigned char r, unsigned char g, unsigned char b) : r(r), g(g), b(b) {}
+		color(unsigned char grey) : r(grey), g(grey), b(grey) {}
+	};
+
+	// GL drops primitives with infinite coordinates, so do the painters
+	bool finite(const double * c, unsigned count)
+	{
+		for (unsigned i = 0; i < 2*count; i++)
+		{
+			if (!(c[i] > -infinity && c[i] < infinity))
+				return false;
+		}
+		return true;
+	}
+
+	// the drawing calls the canvas makes, coordinates are x,y pairs
+	class painter
+	{
+	public:
+		virtual ~painter() {}
+		virtual void points(const double * coordinates, unsigned count, double size, color) = 0;
+		virtual void lines(const double * coordinates, unsigned count, color, bool dashed) = 0;
+		virtual void polyline(const double * coordinates, unsigned count, color, bool closed) = 0;
+		virtual void polygons(const double * coordinates, unsigned count, unsigned corners, color) = 0;
+
+		void points(const std::vector<double> & c, double size, color k)
+		{
+			if (c.size() > 1)
+				points(&c[0], (unsigned)c.size() / 2, size, k);
+		}
+		void lines(const std::vector<double> & c, color k, bool dashed = false)
+		{
+			if (c.size() > 3)
+				lines(&c[0], (unsigned)c.size() / 2, k, dashed);
+		}
+		void polyline(const std::vector<double> & c, color k, bool closed)
+		{
+			if (c.size() > 3)
+				polyline(&c[0], (unsigned)c.size() / 2, k, closed);
+		}
+		void polygons(const std::vector<double> & c, unsigned corners, color k)
+		{
+			if (c.size() >= 2*corners)
+				polygons(&c[0], (unsigned)c.size() / 2, corners, k);
+		}
+	};
+
+	/* the canvas draws with the depth test on and everything at depth 0, so the
+	   first thing drawn stays on top; here the calls go in the reverse order */
+	void paint(const frame & f, double height, painter & p)
+	{
+		bool running = !f.finished;
+
+		if (f.algorithm == TRAPEZOID)
+		{
+			std::vector<double> current, finished, walls;
+			TrapezoidSweep::trapezoid_corners(*f.blue_segments, f.current_trapezoids.data(),
+				f.current_trapezoids.size(), f.trapezoid_bottom, f.trapezoid_top, current);
+			TrapezoidSweep::trapezoid_corners(*f.blue_segments, f.finished_trapezoids.data(),
+				f.finished_trapezoids.size(), f.trapezoid_bottom, f.trapezoid_top, finished);
+			TrapezoidSweep::trapezoid_walls(*f.blue_segments, f.finished_trapezoids.data(),
+				f.finished_trapezoids.size(), f.trapezoid_bottom, f.trapezoid_top, walls);
+			TrapezoidSweep::trapezoid_walls(*f.blue_segments, f.current_trapezoids.data(),
+				f.current_trapezoids.size(), f.trapezoid_bottom, f.trapezoid_top, walls);
+
+			if (running)
+				p.polygons(current, 4, color(255, 255, 200));
+			p.polygons(finished, 4, running ? color(243) : color(255));
+			p.lines(walls, running ? color(220) : color(235));
+			if (running)
+			{
+				double sweep_line[] = { f.sweep_x, 0.0, f.sweep_x, height };
+				p.lines(sweep_line, 2, color(120), true);
+			}
+			p.lines(*f.red_segments, color(255, 170, 140));
+			p.lines(*f.blue_segments, color(140, 170, 255));
+			p.points(f.intersections, running ? 4 : 5, color(0));
+			if (running && f.endpoint_x != infinity)
+			{
+				double current_point[] = { f.endpoint_x, f.endpoint_y };
+				p.points(current_point, 1, 5, f.endpoint_color == RED ? color(255, 0, 0) : color(0, 0, 255));
+			}
+			return;
+		}
+
+		if (f.algorithm == GIFT)
+		{
+			p.lines(f.processed, running ? color(220) : color(235));
+			p.polyline(f.hull, color(255, 160, 150), !running);
+			if (running)
+			{
+				p.lines(f.min_line, color(255, 60, 50));
+				p.lines(f.current_line, color(140, 170, 255));
+			}
+			p.points(*f.points, 5, color(0));
+			if (running && f.current_line.size() > 3 && f.min_line.size() > 3)
+			{
+				p.points(&f.current_line[2], 1, 7, color(140, 170, 255));
+				p.points(&f.min_line[2], 1, 7, color(255, 60, 50));
+				p.points(&f.current_line[0], 1, 7, color(255, 60, 50));
+			}
+			return;
+		}
+
+		if (running && f.triangle.size() > 5)
+			p.polygons(&f.triangle[0], 3, 3, color(243, 243, 255));
+		p.lines(f.processed, running ? color(220) : color(235));
+		p.polyline(f.hull, color(255, 160, 150), true);
+		p.lines(f.current_line, color(140, 170, 255));
+		p.points(*f.points, 5, color(0));
+		p.points(f.current_line, f.current_points.empty() ? 8 : 5, color(140, 170, 255));
+		p.points(f.current_points, 5, color(140, 170, 255));
+	}
+
+	class svg_painter : public painter
+	{
+	public:
+		std::ostringstream out;
+
+		svg_painter(unsigned width, unsigned height)
+		{
+			out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height
+				<< "\" viewBox=\"0 0 " << width << " " << height << "\">\n"
+				<< "<rect width=\"100%\" height=\"100%\" fill=\"#ffffff\"/>\n"
+				<< "<g transform=\"matrix(1 0 0 -1 0 " << height << ")\">\n";
+		}
+
+		std::string finish()
+		{
+			out << "</g>\n</svg>\n";
+			return out.str();
+		}
+
+		void points(const double * c, unsigned count, double size, color k)
+		{
+			for (unsigned i = 0; i < count; i++)
+				if (finite(c + 2*i, 1))
+					out << "<circle cx=\"" << c[2*i] << "\" cy=\"" << c[2*i+1] << "\" r=\"" << size / 2
+					<< "\" fill=\"" << rgb(k) << "\"/>\n";
+		}
+
+		void lines(const double * c, unsigned count, color k, bool dashed)
+		{
+			out << "<path d=\"";
+			for (unsigned i = 0; i + 1 < count; i += 2)
+				if (finite(c + 2*i, 2))
+					out << "M" << c[2*i] << " " << c[2*i+1] << "L" << c[2*i+2] << " " << c[2*i+3];
+			out << "\" fill=\"none\" stroke=\"" << rgb(k) << "\" stroke-width=\"1\"";
+			if (dashed)
+				out << " stroke-dasharray=\"4 4\"";
+			out << "/>\n";
+		}
+
+		void polyline(const double * c, unsigned count, color k, bool closed)
+		{
+			if (!finite(c, count))
+				return;
+			out << "<path d=\"";
+			for (unsigned i = 0; i < count; i++)
+				out << (i ? "L" : "M") << c[2*i] << " " << c[2*i+1];
+			out << (closed ? "Z" : "") << "\" fill=\"none\" stroke=\"" << rgb(k) << "\" stroke-width=\"1\"/>\n";
+		}
+
+		void polygons(const double * c, unsigned count, unsigned corners, color k)
+		{
+			out << "<path d=\"";
+			for (unsigned i = 0; i + corners <= count; i += corners)
+			{
+				if (!finite(c + 2*i, corners))
+					continue;
+				for (unsigned j = 0; j < corners; j++)
+					out << (j ? "L" : "M") << c[2*(i+j)] << " " << c[2*(i+j)+1];
+				out << "Z";
+			}
+			out << "\" fill=\"" << rgb(k) << "\" stroke=\"none\"/>\n";
+		}
+
+	private:
+		static std::string rgb(color k)
+		{
+			std::ostringstream s;
+			s << "rgb(" << (int)k.r << "," << (int)k.g << "," << (int)k.b << ")";
+			return s.str();
+		}
+	};
+
+	// rasterizes like OpenGL does for one pixel wide lines and round points
+	class raster_painter : public painter
+	{
+	public:
+		std::vector<unsigned char> pixels;
+
+		raster_painter(unsigned width, unsigned height)
+			: pixels(3 * (size_t)width * height, 255), width((int)width), height((int)height) {}
+
+		void points(const double * c, unsigned count, double size, color k)
+		{
+			double r = size / 2;
+			for (unsigned i = 0; i < count; i++)
+			{
+				double x = c[2*i], y = c[2*i+1];
+				if (!finite(c + 2*i, 1))
+					continue;
+				for (int py = (int)std::floor(y - r); py <= (int)std::floor(y + r); py++)
+					for (int px = (int)std::floor(x - r); px <= (int)std::floor(x + r); px++)
+					{
+						double dx = px + 0.5 - x, dy = py + 0.5 - y;
+						if (dx*dx + dy*dy <= r*r)
+							plot(px, py, k);
+					}
+			}
+		}
+
+		void lines(const double * c, unsigned count, color k, bool dashed)
+		{
+			for (unsigned i = 0; i + 1 < count; i += 2)
+				line(c[2*i], c[2*i+1], c[2*i+2], c[2*i+3], k, dashed);
+		}
+
+		void polyline(const double * c, unsigned count, color k, bool closed)
+		{
+			for (unsigned i = 0; i + 1 < count; i++)
+				line(c[2*i], c[2*i+1], c[2*i+2], c[2*i+3], k, false);
+			if (closed && count > 2)
+				line(c[2*count-2], c[2*count-1], c[0], c[1], k, false);
+		}
+
+		// scanline fill of every polygon, pixels whose centre is inside are set
+		void polygons(const double * c, unsigned count, unsigned corners, color k)
+		{
+			std::vector<double> crossings;
+			for (unsigned i = 0; i + corners <= count; i += corners)
+			{
+				const double * v = c + 2*i;
+				if (!finite(v, corners))
+					continue;
+				double y_low = v[1], y_high = v[1];
+				for (unsigned j = 1; j < corners; j++)
+				{
+					y_low = std::min(y_low, v[2*j+1]);
+					y_high = std::max(y_high, v[2*j+1]);
+				}
+
+				y_low = std::max(y_low, 0.0);
+				y_high = std::min(y_high, height - 1.0);
+				for (int py = (int)std::floor(y_low); py <= (int)std::floor(y_high); py++)
+				{
+					double y = py + 0.5;
+					crossings.clear();
+					for (unsigned j = 0; j < corners; j++)
+					{
+						const double * a = v + 2*j;
+						const double * b = v + 2*((j+1) % corners);
+						if ((a[1] <= y) != (b[1] <= y))
+							crossings.push_back(a[0] + (y - a[1]) * (b[0] - a[0]) / (b[1] - a[1]));
+					}
+					std::sort(crossings.begin(), crossings.end());
+					for (unsigned j = 0; j + 1 < crossings.size(); j += 2)
+					{
+						double x_right = std::min(crossings[j+1], (double)width);
+						for (int px = (int)std::ceil(std::max(crossings[j], 0.0) - 0.5); px + 0.5 < x_right; px++)
+							plot(px, py, k);
+					}
+				}
+			}
+		}
+
+	private:
+		int width, height;
+
+		void plot(int x, int y, color k)
+		{
+			if (x < 0 || y < 0 || x >= width || y >= height)
+				return;
+			unsigned char * p = &pixels[3 * ((size_t)(height - 1 - y) * width + x)];
+			p[0] = k.r;
+			p[1] = k.g;
+			p[2] = k.b;
+		}
+
+		// the dash pattern is the canvas stipple 0xf0f0, 4 pixels on and 4 off
+		void line(double x0, double y0, double x1, double y1, color k, bool dashed)
+		{
+			double c[] = { x0, y0, x1, y1 };
+			if (!finite(c, 2))
+				return;
+			double steps = std::ceil(std::max(std::fabs(x1 - x0), std::fabs(y1 - y0)));
+			for (unsigned i = 0; i <= steps; i++)
+			{
+				if (dashed && (i / 4) % 2)
+					continue;
+				double t = steps > 0 ? i / steps : 0;
+				plot((int)std::floor(x0 + t * (x1 - x0)), (int)std::floor(y0 + t * (y1 - y0)), k);
+			}
+		}
+	};
+
+	void put32(std::string & out, unsigned value)
+	{
+		out += (char)(value >> 24);
+		out += (char)(value >> 16);
+		out += (char)(value >> 8);
+		out += (char)value;
+	}
+
+	unsigned crc32(const std::string & data, size_t begin)
+	{
+		static unsigned table[256];
+		static bool ready = false;
+		if (!ready)
+		{
+			for (unsigned n = 0; n < 256; n++)
+			{
+				unsigned c = n;
+				for (int k = 0; k < 8; k++)
+					c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+				table[n] = c;
+			}
+			ready = true;
+		}
+
+		unsigned crc = 0xffffffffu;
+		for (size_t i = begin; i < data.size(); i++)
+			crc = table[(crc ^ (unsigned char)data[i]) & 0xff] ^ (crc >> 8);
+		return crc ^ 0xffffffffu;
+	}
+
+	void chunk(std::string & png, const char * type, const std::string & data)
+	{
+		put32(png, (unsigned)data.size());
+		size_t begin = png.size();
+		png += type;
+		png += data;
+		put32(png, crc32(png, begin));
+	}
+
+	/* PNG with uncompressed deflate blocks, there is no zlib in the build;
+	   frames are mostly white, an image viewer or optipng shrinks them later */
+	std::string encode_png(const std::vector<unsigned char> & pixels, unsigned width, unsigned height)
+	{
+		std::string raw;
+		raw.reserve((3 * (size_t)width + 1) * height);
+		for (unsigned y = 0; y < height; y++)
+		{
+			raw += '\0';
+			raw.append((const char *)&pixels[3 * (size_t)y * width], 3 * (size_t)width);
+		}
+
+		std::string zlib;
+		zlib += (char)0x78;
+		zlib += (char)0x01;
+		size_t i = 0;
+		do
+		{
+			size_t length = std::min(raw.size() - i, (size_t)65535);
+			zlib += (char)(i + length == raw.size() ? 1 : 0);	// last block
+			zlib += (char)(length & 0xff);
+			zlib += (char)(length >> 8);
+			zlib += (char)(~length & 0xff);
+			zlib += (char)((~length >> 8) & 0xff);
+			zlib.append(raw, i, length);
+			i += length;
+		}
+		while (i < raw.size());
+		unsigned a = 1, b = 0;
+		for (size_t i = 0; i < raw.size(); i++)
+		{
+			a = (a + (unsigned char)raw[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+		put32(zlib, (b << 16) | a);
+
+		std::string header;
+		put32(header, width);
+		put32(header, height);
+		header += (char)8;	// bit depth
+		header += (char)2;	// RGB
+		header += std::string(3, '\0');
+
+		std::string png("\x89PNG\r\n\x1a\n", 8);
+		chunk(png, "IHDR", header);
+		chunk(png, "IDAT", zlib);
+		chunk(png, "IEND", std::string());
+		return png;
+	}
+
+	bool write_file(const std::string & path, const std::string & data)
+	{
+		std::ofstream out(path.c_str(), std::ios::binary);
+		out.write(data.data(), data.size());
+		return out.good();
+	}
+}
+
+std::string frame_to_svg(const frame & f, unsigned width, unsigned height)
+{
+	svg_painter p(width, height);
+	paint(f, height, p);
+	return p.finish();
+}
+
+std::vector<unsigned char> frame_to_pixels(const frame & f, unsigned width, unsigned height)
+{
+	raster_painter p(width, height);
+	paint(f, height, p);
+	return p.pixels;
+}
+
+bool write_svg(const frame & f, unsigned width, unsigned height, const std::string & path)
+{
+	return write_file(path, frame_to_svg(f, width, height));
+}
+
+bool write_png(const frame & f, unsigned width, unsigned height, const std::string & path)
+{
+	return write_file(path, encode_png(frame_to_pixels(f, width, height), width, height));
+}
+
+unsigned export_frames(const std::vector<double> & blue_endpoints, const std::vector<double> & red_endpoints,
+	const std::vector<double> & points, const export_options & options, ThreadPool & pool)
+{
+	// one copy of the input shared by all replays and frames
+	shared_input blue = std::make_shared<const std::vector<double> >(blue_endpoints);
+	shared_input red = std::make_shared<const std::vector<double> >(red_endpoints);
+	shared_input hull_points = std::make_shared<const std::vector<double> >(points);
+
+	// the step that finishes the run
+	unsigned last = 0;
+	{
+		Replay run(options.algorithm, blue, red, hull_points);
+		while (!run.next_step())
+			last++;
+		last++;
+	}
+
+	std::vector<unsigned> steps;
+	if (options.only_step >= 0)
+		steps.push_back(std::min((unsigned)options.only_step, last));
+	else
+	{
+		unsigned every = options.every ? options.every : 1;
+		for (unsigned step = 0; step < last; step += every)
+			steps.push_back(step);
+		steps.push_back(last);
+	}
+
+	std::vector<unsigned> written(pool.size(), 0);
+	pool.parallel_for((unsigned)steps.size(), [&](unsigned slice, unsigned begin, unsigned end)
+	{
+		Replay run(options.algorithm, blue, red, hull_points);
+		unsigned step = 0;
+		for (unsigned i = begin; i < end; i++)
+		{
+			for (; step < steps[i]; step++)
+				run.next_step();
+
+			std::ostringstream path;
+			path << options.prefix << steps[i] << (options.png ? ".png" : ".svg");
+			frame f = run.capture(steps[i], steps[i] == last);
+			if (options.png ? write_png(f, options.width, options.height, path.str())
+				: write_svg(f, options.width, options.height, path.str()))
+				written[slice]++;
+		}
+	});
+
+	unsigned total = 0;
+	for (unsigned i = 0; i < written.size(); i++)
+		total += written[i];
+	return total;
+}
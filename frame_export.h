@@ -0,0 +1,40 @@
+#ifndef FRAME_EXPORT_H_
+#define FRAME_EXPORT_H_
+
+#include <string>
+#include <vector>
+
+#include "frame.h"
+#include "thread_pool.h"
+
+/* frames are drawn without OpenGL in the same colors and stacking order as
+   the canvas, y goes up like in the canvas; they need their whole histories */
+std::string frame_to_svg(const frame &, unsigned width, unsigned height);
+
+// RGB pixels, rows from the top
+std::vector<unsigned char> frame_to_pixels(const frame &, unsigned width, unsigned height);
+
+bool write_svg(const frame &, unsigned width, unsigned height, const std::string & path);
+bool write_png(const frame &, unsigned width, unsigned height, const std::string & path);
+
+struct export_options
+{
+	mode algorithm;
+	unsigned width;
+	unsigned height;
+	unsigned every;		// every Nth step and the last one
+	int only_step;		// only this step if not negative, the last one if it is too large
+	bool png;		// PNG instead of SVG
+	std::string prefix;	// files are named <prefix><step>.svg/png
+
+	export_options() : algorithm(TRAPEZOID), width(850), height(650), every(1),
+		only_step(-1), png(false), prefix("frame_") {}
+};
+
+/* runs the algorithm on the input to count its steps, then the chosen steps are
+   split across the pool, every slice replays its own copy of the engine up to
+   its steps and writes their frames; returns the number of files written */
+unsigned export_frames(const std::vector<double> & blue_endpoints, const std::vector<double> & red_endpoints,
+	const std::vector<double> & points, const export_options &, ThreadPool &);
+
+#endif
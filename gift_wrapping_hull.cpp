@@ -1,35 +1,37 @@
-#include <cmath>
-#include <stdexcept>
 #include "gift_wrapping_hull.h"
+#include "monotone_chain_hull.h"
+#include "bulk_input.h"
+#include "log.h"
 
-GiftWrappingHull::GiftWrappingHull(std::vector<double> & coordinates)
+namespace
 {
-	if (coordinates.size() < 2) 
+	// below this many points a step is scanned by the calling thread alone
+	const unsigned PARALLEL_SCAN = 8192;
+}
+
+GiftWrappingHull::GiftWrappingHull(const std::vector<double> & coordinates)
+{
+	BulkInput input(coordinates, 2);
+	input_flags = input.errors();
+	if (input.size() == 0)
 		return;
-	
-	point p;
-	init_point.x = coordinates.at(0);
-	for (unsigned i = 0; i < coordinates.size();)
-	{
-		try
-		{
-			p.x = coordinates.at(i++);
-			p.y = coordinates.at(i++);
-		}
-		catch (std::out_of_range)
-		{
-			break;
-		}
 
-		if (p.x <= init_point.x) 
-			init_point = p;
+	unsigned n = input.size();
+	const double * v = input.data();
+	points.resize(n);
+	for (unsigned i = 0; i < n; i++)
+		points[i] = point(v[2*i], v[2*i+1]);
 
-		points.push_back(p);
-	}
+	// the last of the left-most points
+	unsigned last = n - 1;
+	while (points[last].x != input.min_x())
+		last--;
+	init_point = points[last];
 
 	report(init_point);
 	endpoint = min_point = init_point;
-	hull_point = point(init_point.x, 0);
+	// the wrap starts upwards from the leftmost point and goes clockwise
+	hull_point = point(init_point.x, init_point.y - 1);
 	current_position = 0;
 	//wrap();
 }
@@ -43,13 +45,9 @@ bool GiftWrappingHull::next_step()
 	if (current_position < points.size())
 	{
 		point p = points.at(current_position);
-		double current_angle = angle(hull_point, endpoint, p);
 
-		if ((current_position == 0) || (current_angle <= min_angle && endpoint != p))
-		{
-			min_angle = current_angle;
+		if ((current_position == 0) || turns_less(p, min_point))
 			min_point = p;
-		}
 		processed.push_back(endpoint.x);
 		processed.push_back(endpoint.y);
 		processed.push_back(p.x);
@@ -60,14 +58,7 @@ bool GiftWrappingHull::next_step()
 	if (current_position >= points.size())
 	{
 		current_position = 0;
-		hull_point = endpoint;
-		endpoint = min_point;
-		convex_hull.push_back(endpoint);
-
-		if (endpoint == init_point)
-			return true;
-		else
-			std::cout << "Convex hull point found at " << endpoint << "." << std::endl;
+		return advance();
 	}			
 	return false;
 }
@@ -78,45 +69,41 @@ void GiftWrappingHull::wrap()
 	if (points.size() < 2)
 		return;
 
-	point p;
-	double current_angle;
+	do
+		min_point = best_candidate(0, (unsigned)points.size());
+	while (!advance());
+}
 
-	for(;;)
+/* every slice picks its best candidate, the slices are folded in input order
+   with the same rule, so the later point still wins ties and the hull is the
+   same as the serial one */
+void GiftWrappingHull::wrap(ThreadPool & pool)
+{
+	if (points.size() < PARALLEL_SCAN || pool.size() < 2)
 	{
-		for (unsigned j = 0; j < points.size(); j++)
-		{
-			p = points.at(j);
-		
-			current_angle = angle(hull_point, endpoint, p);
-
-			if (j == 0)
-			{
-				min_angle = current_angle;
-				min_point = p;
-			}
-
-			if (endpoint == p)
-				continue;
-
-			if (current_angle <= min_angle)
-			{
-				min_angle = current_angle;
-				min_point = p;
-			}
-		}
+		wrap();
+		return;
+	}
 
-		hull_point = endpoint;
-		endpoint = min_point;
-		convex_hull.push_back(endpoint);
+	std::vector<point> slice_best(pool.size());
+	do
+	{
+		unsigned slices = pool.parallel_for((unsigned)points.size(), [&](unsigned slice, unsigned begin, unsigned end)
+		{
+			slice_best[slice] = best_candidate(begin, end);
+		});
 
-		if (endpoint == init_point)
-			break;
-		else
-			std::cout << "Convex hull point found at " << endpoint << "." << std::endl;
+		min_point = slice_best[0];
+		for (unsigned i = 1; i < slices; i++)
+		{
+			if (turns_less(slice_best[i], min_point))
+				min_point = slice_best[i];
+		}
 	}
+	while (!advance());
 }
 
-std::vector<double> GiftWrappingHull::get_convex_hull()
+std::vector<double> GiftWrappingHull::get_convex_hull() const
 {
 	std::vector<double> hull;
 	for(unsigned i = 0; i < convex_hull.size(); i++)
@@ -127,7 +114,7 @@ std::vector<double> GiftWrappingHull::get_convex_hull()
 	return hull;
 }
 
-std::vector<double> GiftWrappingHull::current_line()
+std::vector<double> GiftWrappingHull::current_line() const
 {
 	std::vector<double> line;
 	if (points.size() > 2)
@@ -140,7 +127,7 @@ std::vector<double> GiftWrappingHull::current_line()
 	return line;
 }
 
-std::vector<double> GiftWrappingHull::min_line()
+std::vector<double> GiftWrappingHull::min_line() const
 {
 	std::vector<double> line;
 	if (points.size() > 2)
@@ -153,26 +140,58 @@ std::vector<double> GiftWrappingHull::min_line()
 	return line;
 }
 
-// angle between two vectors
-double GiftWrappingHull::angle(point a, point b, point c) 
+/* whether p is at least as good a next hull point as best: the turn from the
+   last hull edge towards p is not larger than the one towards best; all points
+   lie right of the last edge, so turning less means p lies left of the ray
+   towards best, on the same ray the later point wins, on opposite rays the one
+   ahead of the edge */
+bool GiftWrappingHull::turns_less(point p, point best) const
+{
+	double turn = cross(endpoint, best, p);
+	if (turn != 0)
+		return turn > 0;
+
+	if (endpoint == p)
+		return false;
+	if (endpoint == best)
+		return true;
+
+	point ahead = point(endpoint.x-hull_point.x, endpoint.y-hull_point.y);
+	point to_best = point(best.x-endpoint.x, best.y-endpoint.y);
+	point to_p = point(p.x-endpoint.x, p.y-endpoint.y);
+	return to_p*to_best > 0 || to_p*ahead >= 0;
+}
+
+// best next hull point among points [begin, end)
+point GiftWrappingHull::best_candidate(unsigned begin, unsigned end) const
 {
-	point v1 = point(b.x-a.x, b.y-a.y);
-	point v2 = point(c.x-b.x, c.y-b.y);
+	point best = points[begin];
+	for (unsigned j = begin + 1; j < end; j++)
+	{
+		// collinear points are rare, the full test only runs for them
+		double turn = cross(endpoint, best, points[j]);
+		if (turn > 0 || (turn == 0 && turns_less(points[j], best)))
+			best = points[j];
+	}
+	return best;
+}
 
-	if (v1*v1 == 0 || v2*v2 == 0)
-		return 3.141592;
+// moves to the next hull point, returns 1 when the hull is closed
+bool GiftWrappingHull::advance()
+{
+	hull_point = endpoint;
+	endpoint = min_point;
+	convex_hull.push_back(endpoint);
 
-	double x = v1*v2 / (sqrt(v1*v1) * sqrt(v2*v2));
-	if (x >= 1)
-		return 0;
-	if (x <=-1)
-		return 3.141592;
+	if (endpoint == init_point)
+		return true;
 
-	return acos(x);
+	LOG(LOG_LEVEL_INFO, "Convex hull point found at " << endpoint << ".");
+	return false;
 }
 
 void GiftWrappingHull::report(point p)
 {
 	convex_hull.push_back(p);
-	std::cout << "Convex hull point found at " << p << "." << std::endl;
+	LOG(LOG_LEVEL_INFO, "Convex hull point found at " << p << ".");
 }
\ No newline at end of file
@@ -3,12 +3,13 @@
 
 #include <vector>
 #include "point.h"
+#include "thread_pool.h"
 
 class GiftWrappingHull
 {
 public:
 	GiftWrappingHull(){}
-	GiftWrappingHull(std::vector<double> & );
+	GiftWrappingHull(const std::vector<double> & );
 
 	// step-by-step processing, returns 1 when done
 	bool next_step();
@@ -16,10 +17,16 @@ public:
 	// compute hull in one step
 	void wrap();
 
-	std::vector<double> get_convex_hull();
-	std::vector<double> processed_lines() { return processed; }
-	std::vector<double> current_line();
-	std::vector<double> min_line();
+	// compute hull in one step, the points are scanned in parallel
+	void wrap(ThreadPool &);
+
+	std::vector<double> get_convex_hull() const;
+	const std::vector<double> & processed_lines() const { return processed; }
+	std::vector<double> current_line() const;
+	std::vector<double> min_line() const;
+
+	// input_error flags of the points
+	unsigned input_errors() const { return input_flags; }
 
 private:
 	std::vector<point> points;
@@ -31,10 +38,12 @@ private:
 	point min_point;
 	point endpoint;
 	point hull_point;
-	double min_angle;
+	unsigned input_flags;
 
-	// angle between two vectors
-	double angle(point, point, point);
+	// orientation test, whether p is a better next hull point than best
+	bool turns_less(point p, point best) const;
+	point best_candidate(unsigned begin, unsigned end) const;
+	bool advance();
 	void report(point);
 };
 
@@ -0,0 +1,164 @@
+#ifndef _WIN32
+	#define GL_GLEXT_PROTOTYPES
+#endif
+
+#include <cstdlib>
+
+#include "gl_buffer.h"
+
+#ifndef GL_ARRAY_BUFFER
+	#define GL_ARRAY_BUFFER 0x8892
+#endif
+#ifndef GL_DYNAMIC_DRAW
+	#define GL_DYNAMIC_DRAW 0x88E8
+#endif
+
+namespace
+{
+	// buffer objects are allocated with room for at least this many coordinates
+	const size_t MIN_CAPACITY = 4096;
+
+#ifdef _WIN32
+	// opengl32.dll only exports OpenGL 1.1, the rest comes from the driver
+	typedef void (APIENTRY * gen_buffers_fn)(GLsizei, GLuint *);
+	typedef void (APIENTRY * bind_buffer_fn)(GLenum, GLuint);
+	typedef void (APIENTRY * buffer_data_fn)(GLenum, ptrdiff_t, const void *, GLenum);
+	typedef void (APIENTRY * buffer_sub_data_fn)(GLenum, ptrdiff_t, ptrdiff_t, const void *);
+
+	gen_buffers_fn gen_buffers = 0;
+	bind_buffer_fn bind_buffer = 0;
+	buffer_data_fn buffer_data = 0;
+	buffer_sub_data_fn buffer_sub_data = 0;
+
+	bool load_functions()
+	{
+		gen_buffers = (gen_buffers_fn)wglGetProcAddress("glGenBuffers");
+		bind_buffer = (bind_buffer_fn)wglGetProcAddress("glBindBuffer");
+		buffer_data = (buffer_data_fn)wglGetProcAddress("glBufferData");
+		buffer_sub_data = (buffer_sub_data_fn)wglGetProcAddress("glBufferSubData");
+		return gen_buffers && bind_buffer && buffer_data && buffer_sub_data;
+	}
+#else
+	void gen_buffers(GLsizei n, GLuint * ids) { glGenBuffers(n, ids); }
+	void bind_buffer(GLenum target, GLuint id) { glBindBuffer(target, id); }
+	void buffer_data(GLenum target, ptrdiff_t size, const void * data, GLenum usage)
+	{
+		glBufferData(target, size, data, usage);
+	}
+	void buffer_sub_data(GLenum target, ptrdiff_t offset, ptrdiff_t size, const void * data)
+	{
+		glBufferSubData(target, offset, size, data);
+	}
+
+	bool load_functions() { return true; }
+#endif
+
+	// buffer objects are core since OpenGL 1.5, checked once with the first context
+	bool buffers_available()
+	{
+		static int available = -1;
+		if (available < 0)
+		{
+			const char * version = (const char *)glGetString(GL_VERSION);
+			available = 0;
+			if (version)
+			{
+				char * rest;
+				long major = strtol(version, &rest, 10);
+				long minor = *rest == '.' ? strtol(rest + 1, 0, 10) : 0;
+				available = (major > 1 || (major == 1 && minor >= 5)) && load_functions();
+			}
+		}
+		return available == 1;
+	}
+}
+
+void VertexBuffer::sync(const std::vector<double> & coordinates, unsigned array_generation)
+{
+	size_t n = coordinates.size() & ~(size_t)1;
+	if (n < uploaded || array_generation != generation)
+		uploaded = 0;
+	generation = array_generation;
+	if (n == uploaded)
+		return;
+
+	if (!buffers_available())
+	{
+		vertices.resize(uploaded);
+		vertices.insert(vertices.end(), coordinates.begin() + uploaded, coordinates.begin() + n);
+		uploaded = n;
+		return;
+	}
+
+	if (!id)
+		gen_buffers(1, &id);
+	bind_buffer(GL_ARRAY_BUFFER, id);
+
+	// a larger buffer object starts empty, everything is uploaded again
+	size_t first = uploaded;
+	if (n > capacity)
+	{
+		capacity = 2*capacity > n ? 2*capacity : n;
+		if (capacity < MIN_CAPACITY)
+			capacity = MIN_CAPACITY;
+		buffer_data(GL_ARRAY_BUFFER, capacity * sizeof(float), 0, GL_DYNAMIC_DRAW);
+		first = 0;
+	}
+
+	vertices.assign(coordinates.begin() + first, coordinates.begin() + n);
+	buffer_sub_data(GL_ARRAY_BUFFER, first * sizeof(float), vertices.size() * sizeof(float), &vertices[0]);
+	vertices.clear();
+
+	bind_buffer(GL_ARRAY_BUFFER, 0);
+	uploaded = n;
+}
+
+void VertexBuffer::draw(GLenum mode) const
+{
+	if (uploaded == 0)
+		return;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	if (id)
+	{
+		bind_buffer(GL_ARRAY_BUFFER, id);
+		glVertexPointer(2, GL_FLOAT, 0, 0);
+	}
+	else
+		glVertexPointer(2, GL_FLOAT, 0, &vertices[0]);
+
+	glDrawArrays(mode, 0, (GLsizei)(uploaded / 2));
+
+	if (id)
+		bind_buffer(GL_ARRAY_BUFFER, 0);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void VertexBuffer::draw(GLenum mode, const std::vector<unsigned> & indices) const
+{
+	if (uploaded == 0 || indices.empty())
+		return;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	if (id)
+	{
+		bind_buffer(GL_ARRAY_BUFFER, id);
+		glVertexPointer(2, GL_FLOAT, 0, 0);
+	}
+	else
+		glVertexPointer(2, GL_FLOAT, 0, &vertices[0]);
+
+	glDrawElements(mode, (GLsizei)indices.size(), GL_UNSIGNED_INT, &indices[0]);
+
+	if (id)
+		bind_buffer(GL_ARRAY_BUFFER, 0);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void draw_vertices(GLenum mode, const float * coordinates, unsigned count)
+{
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, coordinates);
+	glDrawArrays(mode, 0, (GLsizei)count);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
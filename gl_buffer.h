@@ -0,0 +1,55 @@
+#ifndef GL_BUFFER_H_
+#define GL_BUFFER_H_
+
+#include <vector>
+#include <cstddef>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+#ifdef __DARWIN__
+	#include <OpenGL/gl.h>
+#else
+	#include <GL/gl.h>
+#endif
+
+/* vertex buffer object mirroring a growing array of x,y coordinates: sync()
+   converts only the coordinates added since the last call to floats and
+   uploads them, so a repaint does not send the whole history to the driver;
+   without buffer objects (OpenGL < 1.5) the floats are drawn from memory;
+   GL calls need the current context, the buffer is created on the first sync */
+class VertexBuffer
+{
+public:
+	VertexBuffer() : id(0), capacity(0), uploaded(0), generation(0) {}
+
+	/* uploads coordinates added since the last sync, all of them if the array got
+	   shorter or its generation differs from the last sync, owners bump the
+	   generation whenever they rebuild the array */
+	void sync(const std::vector<double> &, unsigned generation = 0);
+
+	// the next sync uploads everything, for arrays that were rebuilt
+	void reset() { uploaded = 0; }
+
+	void draw(GLenum mode) const;
+
+	// draws only the given vertices, in the given order
+	void draw(GLenum mode, const std::vector<unsigned> & vertices) const;
+	unsigned size() const { return (unsigned)(uploaded / 2); }
+
+private:
+	GLuint id;
+	size_t capacity;	// coordinates the buffer object has room for
+	size_t uploaded;	// coordinates already in the buffer object
+	unsigned generation;	// generation of the array at the last sync
+	std::vector<float> vertices;	// upload staging, or the vertices if there is no buffer object
+
+	VertexBuffer(const VertexBuffer &);
+	VertexBuffer & operator = (const VertexBuffer &);
+};
+
+// draws a few vertices straight from memory, replaces glBegin/glEnd
+void draw_vertices(GLenum mode, const float * coordinates, unsigned count);
+
+#endif
@@ -0,0 +1,126 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "frame_export.h"
+#include "log.h"
+
+/* renders algorithm steps to files without a display:
+     trapezoid_headless trapezoid|quickhull|gift <input> [options]
+   the input has one point "x y" per line for the hulls and one segment
+   "red|blue x1 y1 x2 y2" per line for the trapezoid sweep */
+
+namespace
+{
+	void usage()
+	{
+		std::cerr << "usage: trapezoid_headless trapezoid|quickhull|gift <input> [options]" << std::endl
+			<< "  -o <prefix>   output file prefix, frame_ by default" << std::endl
+			<< "  -png          write PNG instead of SVG" << std::endl
+			<< "  -every <n>    every nth step and the last one (default 1)" << std::endl
+			<< "  -step <k>     only step k" << std::endl
+			<< "  -size <w>x<h> frame size in pixels (default 850x650)" << std::endl
+			<< "  -threads <t>  threads to render with, all cores by default" << std::endl;
+	}
+
+	bool read_input(const char * path, mode algorithm, std::vector<double> & blue,
+		std::vector<double> & red, std::vector<double> & points)
+	{
+		std::ifstream in(path);
+		if (!in.is_open())
+			return false;
+
+		std::string line;
+		while (std::getline(in, line))
+		{
+			std::istringstream fields(line);
+			if (algorithm == TRAPEZOID)
+			{
+				std::string color;
+				double x1, y1, x2, y2;
+				if (!(fields >> color >> x1 >> y1 >> x2 >> y2))
+					continue;
+				std::vector<double> & target = color == "red" ? red : blue;
+				target.push_back(x1);
+				target.push_back(y1);
+				target.push_back(x2);
+				target.push_back(y2);
+			}
+			else
+			{
+				double x, y;
+				if (!(fields >> x >> y))
+					continue;
+				points.push_back(x);
+				points.push_back(y);
+			}
+		}
+		return true;
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	if (argc < 3)
+	{
+		usage();
+		return 1;
+	}
+
+	export_options options;
+	if (strcmp(argv[1], "trapezoid") == 0)
+		options.algorithm = TRAPEZOID;
+	else if (strcmp(argv[1], "quickhull") == 0)
+		options.algorithm = QUICKHULL;
+	else if (strcmp(argv[1], "gift") == 0)
+		options.algorithm = GIFT;
+	else
+	{
+		usage();
+		return 1;
+	}
+
+	unsigned threads = 0;
+	for (int i = 3; i < argc; i++)
+	{
+		bool has_value = i + 1 < argc;
+		if (strcmp(argv[i], "-png") == 0)
+			options.png = true;
+		else if (strcmp(argv[i], "-o") == 0 && has_value)
+			options.prefix = argv[++i];
+		else if (strcmp(argv[i], "-every") == 0 && has_value)
+			options.every = (unsigned)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-step") == 0 && has_value)
+			options.only_step = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-threads") == 0 && has_value)
+			threads = (unsigned)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-size") == 0 && has_value &&
+			sscanf(argv[++i], "%ux%u", &options.width, &options.height) == 2 && options.width && options.height)
+			continue;
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+
+	std::vector<double> blue, red, points;
+	if (!read_input(argv[2], options.algorithm, blue, red, points))
+	{
+		std::cerr << "Cannot read " << argv[2] << "." << std::endl;
+		return 1;
+	}
+
+	// the engines report every hull point, nobody reads them here
+	log_set_level(LOG_LEVEL_WARNING);
+
+	ThreadPool pool(threads);
+	unsigned written = export_frames(blue, red, points, options, pool);
+	log_drain(std::cerr);
+	std::cout << written << " frames written." << std::endl;
+	return 0;
+}
@@ -0,0 +1,127 @@
+#include <cmath>
+#include <random>
+
+#include "hull_engine.h"
+#include "akl_toussaint.h"
+#include "quickhull.h"
+#include "gift_wrapping_hull.h"
+#include "monotone_chain_hull.h"
+#include "chan_hull.h"
+
+namespace
+{
+	// below this many points sorting them all is the cheapest way
+	const unsigned SMALL_INPUT = 4096;
+
+	// share of points on the hull from which QuickHull is slower than sorting
+	const double LARGE_HULL_FRACTION = 0.4;
+
+	unsigned sample_hull_size(const std::vector<double> & coordinates, unsigned size, std::mt19937 & random)
+	{
+		unsigned n = (unsigned)coordinates.size() / 2;
+		std::vector<double> sample;
+		sample.reserve(2*size);
+		for (unsigned i = 0; i < size; i++)
+		{
+			unsigned j = random() % n;
+			sample.push_back(coordinates[2*j]);
+			sample.push_back(coordinates[2*j+1]);
+		}
+		return (unsigned)MonotoneChainHull(sample).get_convex_hull().size() / 2;
+	}
+}
+
+/* the hull of a sample with s points has h(s) points, h grows like s^a
+   (a = 0 for points in a polygon, 1/3 in a disc, 1 on a circle),
+   a is fitted from two samples and h(n) extrapolated */
+unsigned estimate_hull_size(const std::vector<double> & coordinates)
+{
+	unsigned n = (unsigned)coordinates.size() / 2;
+	unsigned large = 2 * (unsigned)std::sqrt((double)n);
+	if (large < 1024)
+		large = 1024;
+	if (2*large >= n)
+		return (unsigned)MonotoneChainHull(coordinates).get_convex_hull().size() / 2;
+
+	std::mt19937 random(n);
+	unsigned small = large / 4;
+	double h_small = sample_hull_size(coordinates, small, random);
+	double h_large = sample_hull_size(coordinates, large, random);
+
+	double a = std::log(h_large / h_small) / std::log(4.0);
+	if (a < 0)
+		a = 0;
+	if (a > 1)
+		a = 1;
+
+	double h = h_large * std::pow((double)n / large, a);
+	return h < n ? (unsigned)h : n;
+}
+
+hull_engine choose_hull_engine(const std::vector<double> & coordinates)
+{
+	unsigned n = (unsigned)coordinates.size() / 2;
+	if (n < SMALL_INPUT)
+		return HULL_MONOTONE_CHAIN;
+
+	if (estimate_hull_size(coordinates) >= LARGE_HULL_FRACTION * n)
+		return HULL_MONOTONE_CHAIN;
+
+	return HULL_QUICKHULL;
+}
+
+namespace
+{
+	std::vector<double> run_engine(const std::vector<double> & coordinates, hull_engine engine, ThreadPool * pool)
+	{
+		if (engine == HULL_QUICKHULL)
+		{
+			if (pool)
+				return QuickHull(coordinates, *pool).get_convex_hull();
+
+			ThreadPool serial(1);
+			return QuickHull(coordinates, serial).get_convex_hull();
+		}
+
+		if (engine == HULL_GIFT_WRAPPING)
+		{
+			GiftWrappingHull gift(coordinates);
+			if (pool)
+				gift.wrap(*pool);
+			else
+				gift.wrap();
+			return gift.get_convex_hull();
+		}
+
+		if (engine == HULL_CHAN)
+			return ChanHull(coordinates, estimate_hull_size(coordinates)).get_convex_hull();
+
+		return MonotoneChainHull(coordinates).get_convex_hull();
+	}
+}
+
+std::vector<double> compute_convex_hull(const std::vector<double> & coordinates, hull_engine engine, ThreadPool * pool,
+	bool prefilter, unsigned * removed)
+{
+	if (!prefilter)
+		return run_engine(coordinates, engine, pool);
+
+	unsigned filtered;
+	std::vector<double> points = akl_toussaint_filter(coordinates, filtered, pool);
+	if (removed)
+		*removed = filtered;
+	return run_engine(points, engine, pool);
+}
+
+std::vector<double> compute_convex_hull(const std::vector<double> & coordinates, ThreadPool * pool,
+	bool prefilter, unsigned * removed)
+{
+	if (!prefilter)
+		return run_engine(coordinates, choose_hull_engine(coordinates), pool);
+
+	unsigned filtered;
+	std::vector<double> points = akl_toussaint_filter(coordinates, filtered, pool);
+	if (removed)
+		*removed = filtered;
+	return run_engine(points, choose_hull_engine(points), pool);
+}
@@ -0,0 +1,31 @@
+#ifndef HULL_ENGINE_H_
+#define HULL_ENGINE_H_
+
+#include <vector>
+#include "thread_pool.h"
+
+enum hull_engine
+{
+	HULL_QUICKHULL,
+	HULL_GIFT_WRAPPING,
+	HULL_MONOTONE_CHAIN,
+	HULL_CHAN
+};
+
+// number of hull points guessed from the hull of a random sample of the points
+unsigned estimate_hull_size(const std::vector<double> &);
+
+/* monotone chain for small inputs and when a large part of the points lies
+   on the hull, QuickHull otherwise; Chan's algorithm measured slower than
+   QuickHull on every distribution tried, so it is only used when asked for */
+hull_engine choose_hull_engine(const std::vector<double> &);
+
+/* convex hull computed at once by the given engine, QuickHull and gift wrapping
+   run on the pool if there is one; with prefilter the Akl-Toussaint filter runs first and
+   removed gets the number of points it dropped */
+std::vector<double> compute_convex_hull(const std::vector<double> &, hull_engine, ThreadPool * = 0,
+	bool prefilter = false, unsigned * removed = 0);
+std::vector<double> compute_convex_hull(const std::vector<double> &, ThreadPool * = 0,
+	bool prefilter = false, unsigned * removed = 0);
+
+#endif
@@ -0,0 +1,272 @@
+#include "hull_kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	// compiled for AVX2 separately and picked at run time
+	#define HULL_KERNEL_AVX2
+	#define AVX2_TARGET __attribute__((target("avx2")))
+	#include <immintrin.h>
+#elif defined(__AVX2__)
+	// compiled with /arch:AVX2, the whole program requires it
+	#define HULL_KERNEL_AVX2
+	#define AVX2_TARGET
+	#include <immintrin.h>
+#endif
+
+namespace
+{
+	// directed line A->B, area of P is dx*(P.y-B.y) - (P.x-B.x)*dy
+	struct line
+	{
+		double bx, by, dx, dy;
+
+		line(point a, point b) : bx(b.x), by(b.y), dx(a.x-b.x), dy(a.y-b.y) {}
+	};
+
+	// running state of one pass, far0/far1 are indices into the input block
+	struct split_state
+	{
+		unsigned n0, n1;
+		double area0, area1;
+		unsigned far0, far1;
+
+		split_state() : n0(0), n1(0), area0(0.0), area1(0.0), far0(0), far1(0) {}
+	};
+
+	// branch-free append: every point is stored, the count moves only if it belongs to the set
+	void split_scalar(const double * x, const double * y, unsigned begin, unsigned end,
+		const line & l0, const line & l1, double * x0, double * y0, double * x1, double * y1,
+		split_state & s)
+	{
+		for (unsigned i = begin; i < end; i++)
+		{
+			double px = x[i];
+			double py = y[i];
+			double area0 = l0.dx*(py-l0.by) - (px-l0.bx)*l0.dy;
+			double area1 = l1.dx*(py-l1.by) - (px-l1.bx)*l1.dy;
+
+			x0[s.n0] = px;
+			y0[s.n0] = py;
+			s.n0 += area0 > 0;
+			x1[s.n1] = px;
+			y1[s.n1] = py;
+			s.n1 += area1 > 0;
+
+			if (area0 > s.area0)
+			{
+				s.area0 = area0;
+				s.far0 = i;
+			}
+			if (area1 > s.area1)
+			{
+				s.area1 = area1;
+				s.far1 = i;
+			}
+		}
+	}
+
+#ifdef HULL_KERNEL_AVX2
+	// permutations of 32-bit lanes moving the selected doubles of a 4-bit mask to the front
+	struct compress_table
+	{
+		int lanes[16][8];
+		unsigned count[16];
+
+		compress_table()
+		{
+			for (unsigned mask = 0; mask < 16; mask++)
+			{
+				unsigned n = 0;
+				for (unsigned j = 0; j < 4; j++)
+				{
+					if (mask & (1 << j))
+					{
+						lanes[mask][2*n] = 2*j;
+						lanes[mask][2*n+1] = 2*j+1;
+						n++;
+					}
+				}
+				count[mask] = n;
+				for (unsigned j = n; j < 4; j++)
+				{
+					lanes[mask][2*j] = 2*j;
+					lanes[mask][2*j+1] = 2*j+1;
+				}
+			}
+		}
+	};
+
+	const compress_table compress;
+
+	AVX2_TARGET
+	inline void compress_store(double * out, __m256d v, unsigned mask)
+	{
+		__m256i perm = _mm256_loadu_si256((const __m256i *)compress.lanes[mask]);
+		_mm256_storeu_pd(out, _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(v), perm)));
+	}
+
+	// reduces the per-lane maxima, the lowest index wins on ties
+	AVX2_TARGET
+	inline void reduce_max(__m256d area, __m256d index, double & best, unsigned & far)
+	{
+		double a[4];
+		double idx[4];
+		_mm256_storeu_pd(a, area);
+		_mm256_storeu_pd(idx, index);
+		for (unsigned j = 0; j < 4; j++)
+		{
+			if (a[j] > best || (a[j] == best && a[j] > 0 && idx[j] < far))
+			{
+				best = a[j];
+				far = (unsigned)idx[j];
+			}
+		}
+	}
+
+	// whole blocks of 4 points, the rest is left for split_scalar
+	AVX2_TARGET
+	unsigned split_avx2(const double * x, const double * y, unsigned begin, unsigned end,
+		const line & l0, const line & l1, double * x0, double * y0, double * x1, double * y1,
+		split_state & s)
+	{
+		const __m256d zero = _mm256_setzero_pd();
+		const __m256d bx0 = _mm256_set1_pd(l0.bx), by0 = _mm256_set1_pd(l0.by);
+		const __m256d dx0 = _mm256_set1_pd(l0.dx), dy0 = _mm256_set1_pd(l0.dy);
+		const __m256d bx1 = _mm256_set1_pd(l1.bx), by1 = _mm256_set1_pd(l1.by);
+		const __m256d dx1 = _mm256_set1_pd(l1.dx), dy1 = _mm256_set1_pd(l1.dy);
+		const __m256d step = _mm256_set1_pd(4.0);
+
+		__m256d index = _mm256_set_pd(begin+3, begin+2, begin+1, begin);
+		__m256d best0 = zero, best1 = zero;
+		__m256d far0 = zero, far1 = zero;
+
+		unsigned i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			__m256d px = _mm256_loadu_pd(x + i);
+			__m256d py = _mm256_loadu_pd(y + i);
+
+			__m256d area0 = _mm256_sub_pd(_mm256_mul_pd(dx0, _mm256_sub_pd(py, by0)),
+				_mm256_mul_pd(_mm256_sub_pd(px, bx0), dy0));
+			__m256d area1 = _mm256_sub_pd(_mm256_mul_pd(dx1, _mm256_sub_pd(py, by1)),
+				_mm256_mul_pd(_mm256_sub_pd(px, bx1), dy1));
+
+			unsigned mask0 = _mm256_movemask_pd(_mm256_cmp_pd(area0, zero, _CMP_GT_OQ));
+			unsigned mask1 = _mm256_movemask_pd(_mm256_cmp_pd(area1, zero, _CMP_GT_OQ));
+
+			compress_store(x0 + s.n0, px, mask0);
+			compress_store(y0 + s.n0, py, mask0);
+			s.n0 += compress.count[mask0];
+			compress_store(x1 + s.n1, px, mask1);
+			compress_store(y1 + s.n1, py, mask1);
+			s.n1 += compress.count[mask1];
+
+			// strict comparison keeps the first index in every lane
+			__m256d gt0 = _mm256_cmp_pd(area0, best0, _CMP_GT_OQ);
+			__m256d gt1 = _mm256_cmp_pd(area1, best1, _CMP_GT_OQ);
+			best0 = _mm256_blendv_pd(best0, area0, gt0);
+			far0 = _mm256_blendv_pd(far0, index, gt0);
+			best1 = _mm256_blendv_pd(best1, area1, gt1);
+			far1 = _mm256_blendv_pd(far1, index, gt1);
+
+			index = _mm256_add_pd(index, step);
+		}
+
+		reduce_max(best0, far0, s.area0, s.far0);
+		reduce_max(best1, far1, s.area1, s.far1);
+		return i;
+	}
+
+	bool detect_avx2()
+	{
+	#if defined(__GNUC__)
+		return __builtin_cpu_supports("avx2");
+	#else
+		return true;
+	#endif
+	}
+
+	const bool use_avx2 = detect_avx2();
+#endif
+
+	split_result run_split(const point_block & in, unsigned begin, unsigned end,
+		point a0, point b0, point a1, point b1, point_block & out0, point_block & out1,
+		bool vector_path)
+	{
+		line l0(a0, b0);
+		line l1(a1, b1);
+		split_state s;
+
+		/* the outputs grow chunk by chunk, most points of a split usually fall
+		   into neither set and sizing them for the whole input costs a pass of its own */
+		const unsigned chunk = 1024;
+		unsigned n = end - begin;
+		unsigned capacity = (n < chunk ? n : chunk) + 4;
+		out0.x.resize(capacity);
+		out0.y.resize(capacity);
+		out1.x.resize(capacity);
+		out1.y.resize(capacity);
+
+		for (unsigned i = begin; i < end;)
+		{
+			unsigned chunk_end = end - i > chunk ? i + chunk : end;
+			unsigned needed = (s.n0 > s.n1 ? s.n0 : s.n1) + (chunk_end - i) + 4;
+			if (needed > capacity)
+			{
+				capacity = 2*capacity > needed ? 2*capacity : needed;
+				if (capacity > n + 4)
+					capacity = n + 4;
+				out0.x.resize(capacity);
+				out0.y.resize(capacity);
+				out1.x.resize(capacity);
+				out1.y.resize(capacity);
+			}
+
+		#ifdef HULL_KERNEL_AVX2
+			if (vector_path)
+				i = split_avx2(in.x.data(), in.y.data(), i, chunk_end, l0, l1,
+					out0.x.data(), out0.y.data(), out1.x.data(), out1.y.data(), s);
+		#endif
+			if (i < chunk_end)
+				split_scalar(in.x.data(), in.y.data(), i, chunk_end, l0, l1,
+					out0.x.data(), out0.y.data(), out1.x.data(), out1.y.data(), s);
+			i = chunk_end;
+		}
+
+		out0.x.resize(s.n0);
+		out0.y.resize(s.n0);
+		out1.x.resize(s.n1);
+		out1.y.resize(s.n1);
+
+		split_result result;
+		result.area0 = s.area0;
+		result.area1 = s.area1;
+		result.far0 = s.area0 > 0 ? in.at(s.far0) : point(0.0, 0.0);
+		result.far1 = s.area1 > 0 ? in.at(s.far1) : point(0.0, 0.0);
+		return result;
+	}
+}
+
+split_result split_farthest(const point_block & in, unsigned begin, unsigned end,
+	point a0, point b0, point a1, point b1, point_block & out0, point_block & out1)
+{
+#ifdef HULL_KERNEL_AVX2
+	return run_split(in, begin, end, a0, b0, a1, b1, out0, out1, use_avx2);
+#else
+	return run_split(in, begin, end, a0, b0, a1, b1, out0, out1, false);
+#endif
+}
+
+split_result split_farthest_scalar(const point_block & in, unsigned begin, unsigned end,
+	point a0, point b0, point a1, point b1, point_block & out0, point_block & out1)
+{
+	return run_split(in, begin, end, a0, b0, a1, b1, out0, out1, false);
+}
+
+bool hull_kernel_avx2()
+{
+#ifdef HULL_KERNEL_AVX2
+	return use_avx2;
+#else
+	return false;
+#endif
+}
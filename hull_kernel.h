@@ -0,0 +1,43 @@
+#ifndef HULL_KERNEL_H_
+#define HULL_KERNEL_H_
+
+#include <vector>
+#include "point.h"
+
+// points stored as separate x and y arrays
+struct point_block
+{
+	std::vector<double> x;
+	std::vector<double> y;
+
+	unsigned size() const { return (unsigned)x.size(); }
+	bool empty() const { return x.empty(); }
+	point at(unsigned i) const { return point(x[i], y[i]); }
+	void push_back(point p) { x.push_back(p.x); y.push_back(p.y); }
+	void clear() { x.clear(); y.clear(); }
+	void swap(point_block & other) { x.swap(other.x); y.swap(other.y); }
+};
+
+struct split_result
+{
+	point far0;		// point of out0 with the largest area
+	point far1;		// point of out1 with the largest area
+	double area0;		// area of far0, 0 if out0 is empty
+	double area1;		// area of far1, 0 if out1 is empty
+};
+
+/* one pass over points [begin, end) of the block: P goes to out0 if
+   (A0-B0)x(P-B0) > 0 and to out1 if (A1-B1)x(P-B1) > 0, the same signed area
+   QuickHull::point_location uses, and the first point with the largest area
+   of each set is returned, out0 and out1 are overwritten */
+split_result split_farthest(const point_block & in, unsigned begin, unsigned end,
+	point a0, point b0, point a1, point b1, point_block & out0, point_block & out1);
+
+// the same without the AVX2 path
+split_result split_farthest_scalar(const point_block & in, unsigned begin, unsigned end,
+	point a0, point b0, point a1, point b1, point_block & out0, point_block & out1);
+
+// true if split_farthest runs the AVX2 path on this machine
+bool hull_kernel_avx2();
+
+#endif
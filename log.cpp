@@ -0,0 +1,83 @@
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "log.h"
+
+namespace
+{
+	// queued messages, new ones are dropped while the queue is full
+	const unsigned LOG_CAPACITY = 4096;
+
+	std::atomic<int> current_level(LOG_LEVEL_INFO);
+
+	/* ring buffer of messages: the strings are moved in and out, so the lock
+	   is only held for a few pointer swaps and no thread formats under it */
+	struct ring
+	{
+		std::mutex lock;
+		std::vector<std::string> messages;
+		unsigned long long head;	// next message to write out
+		unsigned long long tail;	// next free slot
+		unsigned long long dropped;
+
+		ring() : messages(LOG_CAPACITY), head(0), tail(0), dropped(0) {}
+	};
+
+	ring & queue()
+	{
+		static ring r;
+		return r;
+	}
+}
+
+void log_set_level(log_level level)
+{
+	current_level = level;
+}
+
+bool log_enabled(log_level level)
+{
+	return level >= current_level.load(std::memory_order_relaxed);
+}
+
+void log_write(log_level level, std::string message)
+{
+	if (!log_enabled(level))
+		return;
+
+	ring & r = queue();
+	std::lock_guard<std::mutex> guard(r.lock);
+	if (r.tail - r.head == LOG_CAPACITY)
+	{
+		r.dropped++;
+		return;
+	}
+	r.messages[r.tail % LOG_CAPACITY].swap(message);
+	r.tail++;
+}
+
+void log_drain(std::ostream & out)
+{
+	ring & r = queue();
+	std::vector<std::string> batch;
+	unsigned long long dropped;
+	{
+		std::lock_guard<std::mutex> guard(r.lock);
+		batch.resize((size_t)(r.tail - r.head));
+		for (unsigned i = 0; r.head < r.tail; i++, r.head++)
+			batch[i].swap(r.messages[r.head % LOG_CAPACITY]);
+		dropped = r.dropped;
+		r.dropped = 0;
+	}
+
+	if (batch.empty() && dropped == 0)
+		return;
+
+	// one flush for the whole batch
+	for (unsigned i = 0; i < batch.size(); i++)
+		out << batch[i] << '\n';
+	if (dropped)
+		out << dropped << " log messages dropped." << '\n';
+	out.flush();
+}
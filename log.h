@@ -0,0 +1,48 @@
+#ifndef LOG_H_
+#define LOG_H_
+
+#include <ostream>
+#include <sstream>
+#include <string>
+
+enum log_level
+{
+	LOG_LEVEL_DEBUG,
+	LOG_LEVEL_INFO,
+	LOG_LEVEL_WARNING,
+	LOG_LEVEL_ERROR,
+	LOG_LEVEL_OFF
+};
+
+// messages below this level are compiled out, e.g. -DLOG_MIN_LEVEL=LOG_LEVEL_WARNING
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// messages below this level are dropped at run time, LOG_LEVEL_INFO at start
+void log_set_level(log_level);
+bool log_enabled(log_level);
+
+/* queues a finished message, callable from any thread; it is taken by value so a
+   temporary is moved into the queue. when the queue is full the message is dropped and counted */
+void log_write(log_level, std::string);
+
+/* writes out the queued messages, one per line, from the thread that owns the
+   stream (the GUI redirects std::cout to a text control that is not thread safe) */
+void log_drain(std::ostream &);
+
+/* LOG(LOG_LEVEL_INFO, "point " << p) formats the message only if the level is
+   enabled, the message is written out by the next log_drain() */
+#define LOG(level, message) \
+	do \
+	{ \
+		if ((level) >= LOG_MIN_LEVEL && log_enabled(level)) \
+		{ \
+			std::ostringstream log_stream; \
+			log_stream << message; \
+			log_write(level, log_stream.str()); \
+		} \
+	} \
+	while (0)
+
+#endif
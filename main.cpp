@@ -26,6 +26,10 @@ const short int ID_TRAPEZOID = 303;
 const short int ID_START = 401;
 const short int ID_CLEAR = 402;
 const short int ID_SWITCH_COLOR = 403;
+const short int ID_FASTER = 404;
+const short int ID_SLOWER = 405;
+const short int ID_FAST_FORWARD = 406;
+const short int ID_RESET_VIEW = 407;
 
 
 class MainWindow: public wxFrame
@@ -57,6 +61,12 @@ public:
 		menu_plane->Append(ID_START, wxT("&Start\tEnter"));
 		menu_plane->Append(ID_CLEAR, wxT("&Clear\tDel"));
 		menu_plane->Append(ID_SWITCH_COLOR, wxT("S&witch color\tTab"));
+		menu_plane->AppendSeparator();
+		menu_plane->Append(ID_FASTER, wxT("&Faster\tCtrl+Up"));
+		menu_plane->Append(ID_SLOWER, wxT("S&lower\tCtrl+Down"));
+		menu_plane->Append(ID_FAST_FORWARD, wxT("Fast f&orward\tCtrl+F"));
+		menu_plane->AppendSeparator();
+		menu_plane->Append(ID_RESET_VIEW, wxT("&Reset view\tCtrl+0"));
 
 		wxMenu *menu_help = new wxMenu;		
 		menu_help->Append(wxID_ABOUT, wxT("&About...\tAlt+A"));
@@ -117,6 +127,26 @@ public:
 		canvas->switch_color();
 	}
 
+	void on_menu_plane_faster(wxCommandEvent& WXUNUSED(event))
+	{
+		canvas->faster();
+	}
+
+	void on_menu_plane_slower(wxCommandEvent& WXUNUSED(event))
+	{
+		canvas->slower();
+	}
+
+	void on_menu_plane_fast_forward(wxCommandEvent& WXUNUSED(event))
+	{
+		canvas->toggle_fast_forward();
+	}
+
+	void on_menu_plane_reset_view(wxCommandEvent& WXUNUSED(event))
+	{
+		canvas->reset_view();
+	}
+
 	void on_menu_file_exit(wxCommandEvent& WXUNUSED(event))
 	{
 		Close(true);
@@ -150,6 +180,10 @@ BEGIN_EVENT_TABLE(MainWindow, wxFrame)
 	EVT_MENU(ID_CLEAR, MainWindow::on_menu_plane_clear)
 	EVT_MENU(ID_START, MainWindow::on_menu_plane_start)
 	EVT_MENU(ID_SWITCH_COLOR, MainWindow::on_menu_plane_switch)
+	EVT_MENU(ID_FASTER, MainWindow::on_menu_plane_faster)
+	EVT_MENU(ID_SLOWER, MainWindow::on_menu_plane_slower)
+	EVT_MENU(ID_FAST_FORWARD, MainWindow::on_menu_plane_fast_forward)
+	EVT_MENU(ID_RESET_VIEW, MainWindow::on_menu_plane_reset_view)
 	EVT_MENU(wxID_EXIT, MainWindow::on_menu_file_exit)
 	EVT_MENU(wxID_ABOUT, MainWindow::on_menu_help_about)
 	EVT_MENU(ID_TRAPEZOID, MainWindow::on_menu_algorithm_trapezoid)
@@ -0,0 +1,65 @@
+#include <algorithm>
+#include "monotone_chain_hull.h"
+
+MonotoneChainHull::MonotoneChainHull(const std::vector<double> & coordinates)
+{
+	std::vector<point> points;
+	points.reserve(coordinates.size() / 2);
+	for (unsigned i = 0; i + 1 < coordinates.size(); i += 2)
+		points.push_back(point(coordinates[i], coordinates[i+1]));
+
+	std::sort(points.begin(), points.end());
+	convex_hull.resize(2*points.size());
+	convex_hull.resize(monotone_chain(points.data(), (unsigned)points.size(), convex_hull.data()));
+}
+
+std::vector<double> MonotoneChainHull::get_convex_hull() const
+{
+	std::vector<double> hull;
+	hull.reserve(2*convex_hull.size());
+	for (unsigned i = 0; i < convex_hull.size(); i++)
+	{
+		hull.push_back(convex_hull[i].x);
+		hull.push_back(convex_hull[i].y);
+	}
+	return hull;
+}
+
+unsigned upper_chain(const point * points, unsigned n, point * out)
+{
+	unsigned k = 0;
+	for (unsigned i = 0; i < n; i++)
+	{
+		// drop points that do not make a right turn
+		while (k >= 2 && cross(out[k-2], out[k-1], points[i]) >= 0)
+			k--;
+		if (k == 1 && out[0] == points[i])
+			continue;
+		out[k++] = points[i];
+	}
+	return k;
+}
+
+unsigned monotone_chain(const point * points, unsigned n, point * out)
+{
+	if (n == 0)
+		return 0;
+	if (points[0] == points[n-1])
+	{
+		out[0] = points[0];
+		return 1;
+	}
+
+	// upper chain left to right, then lower chain right to left
+	unsigned k = upper_chain(points, n, out);
+	unsigned upper = k;
+	for (unsigned i = n - 1; i-- > 0;)
+	{
+		while (k > upper && cross(out[k-2], out[k-1], points[i]) >= 0)
+			k--;
+		out[k++] = points[i];
+	}
+
+	// the first point closes the lower chain
+	return k - 1;
+}
@@ -0,0 +1,29 @@
+#ifndef MONOTONE_CHAIN_HULL_H_
+#define MONOTONE_CHAIN_HULL_H_
+
+#include <vector>
+#include "point.h"
+
+/* Andrew's monotone chain, O(n log n); hull points are returned in the same
+   order as QuickHull: the smallest point, upper chain, the largest point, lower chain */
+class MonotoneChainHull
+{
+public:
+	MonotoneChainHull(){}
+	MonotoneChainHull(const std::vector<double> &);
+
+	std::vector<double> get_convex_hull() const;
+
+private:
+	std::vector<point> convex_hull;
+};
+
+/* upper hull of n points sorted by point::operator <, from the first point
+   to the last one, out needs room for n points, returns the number of hull points */
+unsigned upper_chain(const point *, unsigned, point *);
+
+/* whole hull of n sorted points in MonotoneChainHull order without collinear
+   points, out needs room for 2n points, returns the number of hull points */
+unsigned monotone_chain(const point *, unsigned, point *);
+
+#endif
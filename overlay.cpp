@@ -0,0 +1,716 @@
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+#include "overlay.h"
+#include "trapezoid_sweep.h"
+#include "point.h"
+#include "log.h"
+
+namespace
+{
+	// an edge of a polygon with the side its interior is on
+	struct polygon_side
+	{
+		point a, b;
+		unsigned polygon;
+		bool inside_left;
+
+		bool operator < (const polygon_side & s) const { return a < s.a || (a == s.a && b < s.b); }
+	};
+
+	// outgoing half-edges of a vertex by angle
+	struct by_angle
+	{
+		const std::vector<double> * angles;
+		bool operator () (unsigned h1, unsigned h2) const { return (*angles)[h1] < (*angles)[h2]; }
+	};
+
+	// strips a horizontal ray from a vertex is checked against
+	const unsigned STRIP_EDGES = 16;
+
+	// stands for the point looked up among the edges of an edge_order
+	const unsigned PROBE = 0xffffffff;
+
+	/* edges of a layer crossed by one vertical line, from bottom to top; they do
+	   not cross, so the edge starting further right is compared with the other
+	   one, from its start or, if that is shared, from its end */
+	struct edge_order
+	{
+		const std::vector<point> * ends;	// edge i from ends[2i] to ends[2i+1], left to right
+		const point * probe;
+
+		bool operator () (unsigned e, unsigned f) const
+		{
+			const std::vector<point> & p = *ends;
+			if (f == PROBE)
+				return cross(p[2*e], p[2*e + 1], *probe) > 0;
+			if (e == PROBE)
+				return cross(p[2*f], p[2*f + 1], *probe) < 0;
+			if (e == f)
+				return false;
+
+			bool e_first = p[2*e].x <= p[2*f].x;
+			unsigned base = e_first ? e : f, other = e_first ? f : e;
+			double side = cross(p[2*base], p[2*base + 1], p[2*other]);
+			if (side == 0)
+				side = cross(p[2*base], p[2*base + 1], p[2*other + 1]);
+			if (side == 0)
+				return e < f;
+			return e_first ? side > 0 : side < 0;
+		}
+	};
+
+	// sweep events at the same x: edges ending there go first, new edges last
+	enum touch_event_kind { EDGE_END, VERTEX, EDGE_START };
+
+	struct touch_event
+	{
+		double x;
+		touch_event_kind kind;
+		unsigned id;
+
+		bool operator < (const touch_event & t) const { return x < t.x || (x == t.x && kind < t.kind); }
+	};
+}
+
+Overlay::Overlay(const std::vector<std::vector<double> > & red_polygons,
+	const std::vector<std::vector<double> > & blue_polygons, status_structure status)
+	: crossing_count(0), overlap_count(0)
+{
+	std::vector<layer_edge> red, blue;
+	layer_edges(red_polygons, red);
+	layer_edges(blue_polygons, blue);
+
+	std::vector<bool> red_shared, blue_shared;
+	cut_touching(red, blue, red_shared, blue_shared);
+
+	// the edges are split while the sweep runs, a pair is only looked at once
+	std::vector<std::vector<point> > red_splits(red.size()), blue_splits(blue.size());
+	{
+		std::vector<unsigned> red_ids, blue_ids;
+		TrapezoidSweep sweep(segments(blue, blue_shared, blue_ids), segments(red, red_shared, red_ids), status);
+		sweep.keep_trapezoids = false;
+		size_t seen = 0;
+		for (bool done = false; !done;)
+		{
+			done = sweep.next_step();
+			const std::vector<unsigned> & pairs = sweep.intersecting_pairs();
+			for (; seen < pairs.size(); seen += 2)
+			{
+				unsigned ri = red_ids[pairs[seen]], bi = blue_ids[pairs[seen + 1]];
+				const layer_edge & r = red[ri];
+				const layer_edge & b = blue[bi];
+				point at;
+				if (!meet(r.a, r.b, b.a, b.b, at))
+					continue;
+				crossing_count++;
+				if (at != r.a && at != r.b)
+					red_splits[ri].push_back(at);
+				if (at != b.a && at != b.b)
+					blue_splits[bi].push_back(at);
+			}
+		}
+	}
+
+	// vertices in point order, so a piece of an edge runs from the lower to the higher id
+	for (unsigned i = 0; i < red.size(); i++)
+	{
+		points.push_back(red[i].a);
+		points.push_back(red[i].b);
+		points.insert(points.end(), red_splits[i].begin(), red_splits[i].end());
+	}
+	for (unsigned i = 0; i < blue.size(); i++)
+	{
+		points.push_back(blue[i].a);
+		points.push_back(blue[i].b);
+		points.insert(points.end(), blue_splits[i].begin(), blue_splits[i].end());
+	}
+	std::sort(points.begin(), points.end());
+	points.erase(std::unique(points.begin(), points.end()), points.end());
+
+	std::vector<piece> pieces;
+	split(red, red_splits, true, pieces);
+	split(blue, blue_splits, false, pieces);
+
+	// red and blue edges with the same ends are one edge
+	std::sort(pieces.begin(), pieces.end(), [](const piece & p, const piece & q)
+	{
+		return p.u < q.u || (p.u == q.u && p.v < q.v);
+	});
+	size_t kept = 0;
+	for (size_t i = 0; i < pieces.size(); i++)
+	{
+		if (kept > 0 && pieces[kept - 1].u == pieces[i].u && pieces[kept - 1].v == pieces[i].v)
+		{
+			piece & p = pieces[kept - 1];
+			if (pieces[i].red && !p.red)
+			{
+				p.red = true;
+				p.red_left = pieces[i].red_left;
+				p.red_right = pieces[i].red_right;
+			}
+			if (pieces[i].blue && !p.blue)
+			{
+				p.blue = true;
+				p.blue_left = pieces[i].blue_left;
+				p.blue_right = pieces[i].blue_right;
+			}
+		}
+		else
+			pieces[kept++] = pieces[i];
+	}
+	pieces.resize(kept);
+
+	link(pieces);
+	make_faces(pieces);
+}
+
+void Overlay::layer_edges(const std::vector<std::vector<double> > & polygons, std::vector<layer_edge> & out)
+{
+	std::vector<polygon_side> sides;
+	unsigned skipped = 0;
+	for (unsigned p = 0; p < polygons.size(); p++)
+	{
+		const std::vector<double> & ring = polygons[p];
+		size_t n = ring.size() / 2;
+		bool finite = n >= 3;
+		for (size_t i = 0; finite && i < 2 * n; i++)
+			finite = std::isfinite(ring[i]);
+
+		// twice the signed area, positive for counterclockwise rings
+		double area = 0;
+		for (size_t i = 0; finite && i < n; i++)
+		{
+			size_t j = (i + 1) % n;
+			area += ring[2*i] * ring[2*j + 1] - ring[2*j] * ring[2*i + 1];
+		}
+		if (!finite || area == 0)
+		{
+			skipped++;
+			continue;
+		}
+
+		for (size_t i = 0; i < n; i++)
+		{
+			size_t j = (i + 1) % n;
+			polygon_side s;
+			s.a = point(ring[2*i], ring[2*i + 1]);
+			s.b = point(ring[2*j], ring[2*j + 1]);
+			s.polygon = p;
+			s.inside_left = area > 0;
+			if (s.a == s.b)
+				continue;
+			if (s.b < s.a)
+			{
+				std::swap(s.a, s.b);
+				s.inside_left = !s.inside_left;
+			}
+			sides.push_back(s);
+		}
+	}
+	if (skipped > 0)
+		LOG(LOG_LEVEL_WARNING, "Skipped " << skipped << " polygons without area or with coordinates that are not finite.");
+
+	// an edge shared by two polygons has one on each side
+	std::sort(sides.begin(), sides.end());
+	for (size_t i = 0; i < sides.size(); i++)
+	{
+		if (out.empty() || out.back().a != sides[i].a || out.back().b != sides[i].b)
+		{
+			layer_edge e;
+			e.a = sides[i].a;
+			e.b = sides[i].b;
+			e.left = e.right = NONE;
+			out.push_back(e);
+		}
+		(sides[i].inside_left ? out.back().left : out.back().right) = sides[i].polygon;
+	}
+}
+
+// x1,y1,x2,y2 of the edges that are not shared, ids maps their place to the edge
+std::vector<double> Overlay::segments(const std::vector<layer_edge> & layer, const std::vector<bool> & shared,
+	std::vector<unsigned> & ids)
+{
+	std::vector<double> v;
+	v.reserve(4 * layer.size());
+	for (unsigned i = 0; i < layer.size(); i++)
+	{
+		if (shared[i])
+			continue;
+		ids.push_back(i);
+		v.push_back(layer[i].a.x);
+		v.push_back(layer[i].a.y);
+		v.push_back(layer[i].b.x);
+		v.push_back(layer[i].b.y);
+	}
+	return v;
+}
+
+/* a vertex of one layer inside an edge of the other is a touch the sweep does not
+   report reliably, and collinear edges are parallel for it; each edge is cut here
+   at the vertices of the other layer inside it, then the parts of red and blue
+   edges that overlap are the same edge in both layers, they are marked shared and
+   not swept: no edge of either layer can cross them */
+void Overlay::cut_touching(std::vector<layer_edge> & red, std::vector<layer_edge> & blue,
+	std::vector<bool> & red_shared, std::vector<bool> & blue_shared)
+{
+	std::vector<std::vector<point> > red_splits(red.size()), blue_splits(blue.size());
+	vertices_inside(blue, red, red_splits);
+	vertices_inside(red, blue, blue_splits);
+
+	/* edges of a layer do not overlap each other, so the parts of a red edge inside
+	   a blue one are cut at the same points as the blue edge */
+	cut(red, red_splits);
+	cut(blue, blue_splits);
+	red_shared.assign(red.size(), false);
+	blue_shared.assign(blue.size(), false);
+
+	auto before = [](const layer_edge & e, const layer_edge & f)
+	{
+		return e.a < f.a || (e.a == f.a && e.b < f.b);
+	};
+	std::vector<layer_edge> sorted(blue);
+	std::vector<unsigned> order(blue.size());
+	for (unsigned i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&](unsigned i, unsigned j) { return before(blue[i], blue[j]); });
+	for (unsigned i = 0; i < order.size(); i++)
+		sorted[i] = blue[order[i]];
+	for (unsigned i = 0; i < red.size(); i++)
+	{
+		size_t k = std::lower_bound(sorted.begin(), sorted.end(), red[i], before) - sorted.begin();
+		if (k < sorted.size() && sorted[k].a == red[i].a && sorted[k].b == red[i].b)
+		{
+			red_shared[i] = blue_shared[order[k]] = true;
+			overlap_count++;
+		}
+	}
+}
+
+/* splits[i] gets the vertices of from lying inside edge i of layer: a sweep keeps
+   the edges crossed by the vertical line through each vertex in order and looks the
+   vertex up among them with the exact side test of meet(); vertical edges are
+   looked up by their lower end */
+void Overlay::vertices_inside(const std::vector<layer_edge> & from, const std::vector<layer_edge> & layer,
+	std::vector<std::vector<point> > & splits)
+{
+	std::vector<point> vertices;
+	vertices.reserve(2 * from.size());
+	for (size_t i = 0; i < from.size(); i++)
+	{
+		vertices.push_back(from[i].a);
+		vertices.push_back(from[i].b);
+	}
+	std::sort(vertices.begin(), vertices.end());
+	vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+	std::vector<point> ends(2 * layer.size());
+	std::vector<touch_event> events;
+	std::vector<unsigned> vertical;
+	for (unsigned i = 0; i < layer.size(); i++)
+	{
+		ends[2*i] = layer[i].a;
+		ends[2*i + 1] = layer[i].b;
+		if (layer[i].a.x == layer[i].b.x)
+		{
+			vertical.push_back(i);
+			continue;
+		}
+		touch_event start = { layer[i].a.x, EDGE_START, i }, end = { layer[i].b.x, EDGE_END, i };
+		events.push_back(start);
+		events.push_back(end);
+	}
+	for (unsigned v = 0; v < vertices.size(); v++)
+	{
+		touch_event e = { vertices[v].x, VERTEX, v };
+		events.push_back(e);
+	}
+	std::sort(events.begin(), events.end());
+	std::sort(vertical.begin(), vertical.end(), [&layer](unsigned i, unsigned j) { return layer[i].a < layer[j].a; });
+
+	// only edges with the vertex strictly between their ends in x are open at a vertex
+	point probe;
+	edge_order order = { &ends, &probe };
+	std::set<unsigned, edge_order> open(order);
+	for (size_t k = 0; k < events.size(); k++)
+	{
+		const touch_event & e = events[k];
+		if (e.kind == EDGE_START)
+			open.insert(e.id);
+		else if (e.kind == EDGE_END)
+			open.erase(e.id);
+		else
+		{
+			probe = vertices[e.id];
+			std::set<unsigned, edge_order>::const_iterator on = open.find(PROBE);
+			if (on != open.end())
+				splits[*on].push_back(probe);
+
+			std::vector<unsigned>::const_iterator up = std::upper_bound(vertical.begin(), vertical.end(), probe,
+				[&layer](point p, unsigned i) { return p < layer[i].a; });
+			if (up != vertical.begin())
+			{
+				const layer_edge & s = layer[*(up - 1)];
+				if (s.a.x == probe.x && s.a.y < probe.y && probe.y < s.b.y)
+					splits[*(up - 1)].push_back(probe);
+			}
+		}
+	}
+}
+
+// cuts edge i at splits[i] into edges of the same polygons, the new ones are appended
+void Overlay::cut(std::vector<layer_edge> & layer, std::vector<std::vector<point> > & splits)
+{
+	size_t n = layer.size();
+	for (size_t i = 0; i < n; i++)
+	{
+		std::vector<point> & at = splits[i];
+		if (at.empty())
+			continue;
+		std::sort(at.begin(), at.end());
+		at.erase(std::unique(at.begin(), at.end()), at.end());
+
+		layer_edge e = layer[i];
+		layer[i].b = at[0];
+		at.push_back(e.b);
+		for (size_t k = 0; k + 1 < at.size(); k++)
+		{
+			e.a = at[k];
+			e.b = at[k + 1];
+			layer.push_back(e);
+		}
+	}
+}
+
+unsigned Overlay::vertex(point p) const
+{
+	return (unsigned)(std::lower_bound(points.begin(), points.end(), p) - points.begin());
+}
+
+void Overlay::split(const std::vector<layer_edge> & layer, std::vector<std::vector<point> > & splits,
+	bool red, std::vector<piece> & pieces) const
+{
+	for (unsigned i = 0; i < layer.size(); i++)
+	{
+		// along the edge the points are in point order
+		std::vector<point> & at = splits[i];
+		std::sort(at.begin(), at.end());
+		at.erase(std::unique(at.begin(), at.end()), at.end());
+		at.push_back(layer[i].b);
+
+		piece p;
+		p.red = red;
+		p.blue = !red;
+		p.red_left = p.red_right = p.blue_left = p.blue_right = NONE;
+		(red ? p.red_left : p.blue_left) = layer[i].left;
+		(red ? p.red_right : p.blue_right) = layer[i].right;
+		p.u = vertex(layer[i].a);
+		for (size_t k = 0; k < at.size(); k++)
+		{
+			p.v = vertex(at[k]);
+			pieces.push_back(p);
+			p.u = p.v;
+		}
+		std::vector<point>().swap(at);
+	}
+}
+
+/* half-edge 2i runs along piece i from u to v, 2i+1 back; around a vertex the
+   half-edge after an incoming one is the next outgoing one clockwise, so every
+   face is on the left of its boundary */
+void Overlay::link(const std::vector<piece> & pieces)
+{
+	edges.resize(2 * pieces.size());
+	std::vector<double> angles(edges.size());
+	for (unsigned i = 0; i < pieces.size(); i++)
+	{
+		half_edge & h = edges[2*i];
+		half_edge & t = edges[2*i + 1];
+		h.origin = pieces[i].u;
+		t.origin = pieces[i].v;
+		h.twin = 2*i + 1;
+		t.twin = 2*i;
+		h.face = t.face = NONE;
+		point u = points[pieces[i].u], v = points[pieces[i].v];
+		angles[2*i] = std::atan2(v.y - u.y, v.x - u.x);
+		angles[2*i + 1] = std::atan2(u.y - v.y, u.x - v.x);
+	}
+
+	std::vector<unsigned> start(points.size() + 1, 0);
+	for (unsigned h = 0; h < edges.size(); h++)
+		start[edges[h].origin + 1]++;
+	for (unsigned v = 0; v < points.size(); v++)
+		start[v + 1] += start[v];
+	std::vector<unsigned> outgoing(edges.size());
+	std::vector<unsigned> fill(start.begin(), start.end() - 1);
+	for (unsigned h = 0; h < edges.size(); h++)
+		outgoing[fill[edges[h].origin]++] = h;
+
+	by_angle order = { &angles };
+	for (unsigned v = 0; v < points.size(); v++)
+	{
+		unsigned first = start[v], count = start[v + 1] - first;
+		std::sort(outgoing.begin() + first, outgoing.begin() + first + count, order);
+		for (unsigned k = 0; k < count; k++)
+		{
+			unsigned in = edges[outgoing[first + k]].twin;
+			unsigned out = outgoing[first + (k + count - 1) % count];
+			edges[in].next = out;
+			edges[out].prev = in;
+		}
+	}
+}
+
+void Overlay::make_faces(const std::vector<piece> & pieces)
+{
+	face unbounded = { NONE, NONE, NONE };
+	face_list.push_back(unbounded);
+
+	// bounded faces are traced counterclockwise, the other cycles are the outer boundaries of components
+	std::vector<unsigned> hole_cycles;
+	std::vector<bool> traced(edges.size(), false);
+	for (unsigned h = 0; h < edges.size(); h++)
+	{
+		if (traced[h])
+			continue;
+		double area = 0;
+		unsigned leftmost = h;
+		unsigned e = h;
+		do
+		{
+			traced[e] = true;
+			point p = points[edges[e].origin], q = points[edges[edges[e].next].origin];
+			area += p.x * q.y - q.x * p.y;
+			if (edges[e].origin < edges[leftmost].origin)
+				leftmost = e;
+			e = edges[e].next;
+		} while (e != h);
+
+		if (area > 0)
+		{
+			face f = { h, NONE, NONE };
+			unsigned id = (unsigned)face_list.size();
+			face_list.push_back(f);
+			e = h;
+			do
+			{
+				edges[e].face = id;
+				e = edges[e].next;
+			} while (e != h);
+		}
+		else
+			hole_cycles.push_back(leftmost);
+	}
+
+	/* each component lies in the face just left of its leftmost vertex; what a ray
+	   to the left meets first is found among the edges of its horizontal strip, holes
+	   further left are done before */
+	double y0 = points.empty() ? 0 : points[0].y, y1 = y0;
+	for (size_t v = 0; v < points.size(); v++)
+	{
+		y0 = std::min(y0, points[v].y);
+		y1 = std::max(y1, points[v].y);
+	}
+	unsigned strips = std::max(1u, (unsigned)(pieces.size() / STRIP_EDGES));
+	double height = y1 > y0 ? (y1 - y0) / strips : 1;
+	std::vector<unsigned> strip_start(strips + 1, 0), strip_edges;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		std::vector<unsigned> fill(strip_start.begin(), strip_start.end() - 1);
+		for (unsigned i = 0; i < pieces.size(); i++)
+		{
+			double low = std::min(points[pieces[i].u].y, points[pieces[i].v].y);
+			double high = std::max(points[pieces[i].u].y, points[pieces[i].v].y);
+			unsigned s0 = std::min(strips - 1, (unsigned)((low - y0) / height));
+			unsigned s1 = std::min(strips - 1, (unsigned)((high - y0) / height));
+			for (unsigned s = s0; s <= s1; s++)
+			{
+				if (pass == 0)
+					strip_start[s + 1]++;
+				else
+					strip_edges[fill[s]++] = i;
+			}
+		}
+		if (pass == 0)
+		{
+			for (unsigned s = 0; s < strips; s++)
+				strip_start[s + 1] += strip_start[s];
+			strip_edges.resize(strip_start[strips]);
+		}
+	}
+
+	std::sort(hole_cycles.begin(), hole_cycles.end(), [this](unsigned a, unsigned b)
+	{
+		return edges[a].origin < edges[b].origin;
+	});
+	std::vector<std::pair<unsigned, unsigned> > face_holes;
+	for (size_t c = 0; c < hole_cycles.size(); c++)
+	{
+		unsigned h = hole_cycles[c];
+		unsigned f = face_left_of(edges[h].origin, strip_start, strip_edges, y0, height);
+		unsigned e = h;
+		do
+		{
+			edges[e].face = f;
+			e = edges[e].next;
+		} while (e != h);
+		face_holes.push_back(std::make_pair(f, h));
+	}
+
+	std::sort(face_holes.begin(), face_holes.end());
+	hole_start.assign(face_list.size() + 1, 0);
+	for (size_t i = 0; i < face_holes.size(); i++)
+	{
+		hole_start[face_holes[i].first + 1]++;
+		hole_edges.push_back(face_holes[i].second);
+	}
+	for (size_t f = 0; f < face_list.size(); f++)
+		hole_start[f + 1] += hole_start[f];
+
+	/* a face gets the polygon on its side of any edge of the layer around it; a face
+	   with no such edge has the polygon of the face on the other side of an edge of
+	   the other layer, since that edge does not separate polygons of this layer */
+	std::vector<unsigned> by_face_start(face_list.size() + 1, 0), by_face(edges.size());
+	for (unsigned h = 0; h < edges.size(); h++)
+		by_face_start[edges[h].face + 1]++;
+	for (size_t f = 0; f < face_list.size(); f++)
+		by_face_start[f + 1] += by_face_start[f];
+	std::vector<unsigned> fill(by_face_start.begin(), by_face_start.end() - 1);
+	for (unsigned h = 0; h < edges.size(); h++)
+		by_face[fill[edges[h].face]++] = h;
+
+	for (int layer = 0; layer < 2; layer++)
+	{
+		bool red = layer == 0;
+		std::vector<bool> known(face_list.size(), false);
+		std::vector<unsigned> queue;
+		known[0] = true;
+		queue.push_back(0);
+		for (unsigned h = 0; h < edges.size(); h++)
+		{
+			const piece & p = pieces[h / 2];
+			unsigned f = edges[h].face;
+			if (known[f] || !(red ? p.red : p.blue))
+				continue;
+			unsigned left = red ? (h % 2 == 0 ? p.red_left : p.red_right) : (h % 2 == 0 ? p.blue_left : p.blue_right);
+			(red ? face_list[f].red : face_list[f].blue) = left;
+			known[f] = true;
+			queue.push_back(f);
+		}
+
+		for (size_t next = 0; next < queue.size(); next++)
+		{
+			unsigned f = queue[next];
+			for (unsigned k = by_face_start[f]; k < by_face_start[f + 1]; k++)
+			{
+				unsigned h = by_face[k];
+				const piece & p = pieces[h / 2];
+				unsigned g = edges[edges[h].twin].face;
+				if (known[g] || (red ? p.red : p.blue))
+					continue;
+				(red ? face_list[g].red : face_list[g].blue) = red ? face_list[f].red : face_list[f].blue;
+				known[g] = true;
+				queue.push_back(g);
+			}
+		}
+	}
+}
+
+unsigned Overlay::face_left_of(unsigned v, const std::vector<unsigned> & strip_start,
+	const std::vector<unsigned> & strip_edges, double strip_y0, double strip_height) const
+{
+	point w = points[v];
+	unsigned strips = (unsigned)strip_start.size() - 1;
+	unsigned s = std::min(strips - 1, (unsigned)((w.y - strip_y0) / strip_height));
+
+	// nearest edge crossed inside, or nearest vertex, on the ray from w to the left
+	double best_x = -HUGE_VAL;
+	unsigned crossed = NONE, hit = NONE;
+	for (unsigned k = strip_start[s]; k < strip_start[s + 1]; k++)
+	{
+		unsigned h = 2 * strip_edges[k];
+		point p = points[edges[h].origin], q = points[edges[edges[h].twin].origin];
+		for (int end = 0; end < 2; end++)
+		{
+			point e = end == 0 ? p : q;
+			if (e.y == w.y && e.x < w.x && e.x >= best_x)
+			{
+				best_x = e.x;
+				hit = end == 0 ? edges[h].origin : edges[edges[h].twin].origin;
+				crossed = NONE;
+			}
+		}
+		if ((p.y < w.y && q.y > w.y) || (p.y > w.y && q.y < w.y))
+		{
+			double x = p.x + (w.y - p.y) * (q.x - p.x) / (q.y - p.y);
+			x = std::max(x, std::min(p.x, q.x));
+			x = std::min(x, std::max(p.x, q.x));
+			if (x < w.x && x > best_x)
+			{
+				best_x = x;
+				// the half-edge going down has the right side of the edge on its left
+				crossed = p.y > q.y ? h : edges[h].twin;
+				hit = NONE;
+			}
+		}
+	}
+
+	if (crossed != NONE)
+		return edges[crossed].face;
+	if (hit == NONE)
+		return 0;
+
+	/* the face between the outgoing half-edges of the vertex around the direction
+	   to the right; the one before it counterclockwise has that face on its left */
+	unsigned around = NONE;
+	double around_angle = -HUGE_VAL, last_angle = -HUGE_VAL;
+	unsigned last = NONE;
+	unsigned first = NONE;
+	for (unsigned k = strip_start[s]; k < strip_start[s + 1]; k++)
+	{
+		for (int end = 0; end < 2; end++)
+		{
+			unsigned h = 2 * strip_edges[k] + end;
+			if (edges[h].origin != hit)
+				continue;
+			first = h;
+			point q = points[edges[edges[h].twin].origin];
+			double angle = std::atan2(q.y - w.y, q.x - points[hit].x);
+			if (angle <= 0 && angle > around_angle)
+			{
+				around_angle = angle;
+				around = h;
+			}
+			if (angle > last_angle)
+			{
+				last_angle = angle;
+				last = h;
+			}
+		}
+	}
+	if (first == NONE)
+		return 0;
+	return edges[around != NONE ? around : last].face;
+}
+
+std::vector<unsigned> Overlay::holes(unsigned f) const
+{
+	return std::vector<unsigned>(hole_edges.begin() + hole_start[f], hole_edges.begin() + hole_start[f + 1]);
+}
+
+std::vector<double> Overlay::boundary(unsigned f) const
+{
+	std::vector<double> ring;
+	unsigned h = face_list[f].outer;
+	if (h == NONE)
+		return ring;
+	unsigned e = h;
+	do
+	{
+		ring.push_back(points[edges[e].origin].x);
+		ring.push_back(points[edges[e].origin].y);
+		e = edges[e].next;
+	} while (e != h);
+	return ring;
+}
@@ -0,0 +1,104 @@
+#ifndef OVERLAY_H_
+#define OVERLAY_H_
+
+#include <vector>
+
+#include "point.h"
+#include "sweep_status.h"
+
+/* overlay of two planar subdivisions, the red and the blue layer: polygons given
+   as rings of x,y without the closing point, neighbors in a layer share their
+   edges exactly and the polygons of a layer do not overlap.
+   the trapezoid sweep finds where red edges cross blue ones, the edges are split
+   there while it runs; then the pieces become the doubly connected edge list of the
+   arrangement and every face gets the red and the blue polygon it lies in.
+   vertices are merged by their exact coordinates, so red and blue edges with the
+   same ends become one edge; before the sweep every edge is cut at the vertices of
+   the other layer lying on it, so edges that touch meet at a vertex and collinear
+   edges that overlap have their common part as one edge, which is left out of the
+   sweep; the sweep then only has to find edges crossing inside both */
+class Overlay
+{
+public:
+	static const unsigned NONE = 0xffffffff;
+
+	struct half_edge
+	{
+		unsigned origin;		// vertex
+		unsigned twin, next, prev;
+		unsigned face;			// face on the left
+	};
+
+	struct face
+	{
+		unsigned outer;			// half-edge of the outer boundary, NONE for the unbounded face
+		unsigned red, blue;		// polygon of each layer the face lies in, NONE outside the layer
+	};
+
+	Overlay(const std::vector<std::vector<double> > & red_polygons,
+		const std::vector<std::vector<double> > & blue_polygons, status_structure status = STATUS_BLOCKS);
+
+	const std::vector<point> & vertices() const { return points; }
+	const std::vector<half_edge> & half_edges() const { return edges; }
+
+	// faces()[0] is the unbounded face
+	const std::vector<face> & faces() const { return face_list; }
+
+	// a half-edge of every boundary of face f inside its outer boundary, one per hole
+	std::vector<unsigned> holes(unsigned f) const;
+
+	// x,y of the outer boundary of face f counterclockwise
+	std::vector<double> boundary(unsigned f) const;
+
+	// red/blue crossings the sweep found
+	unsigned crossings() const { return crossing_count; }
+
+	// parts of red and blue edges that overlap, each one edge of the result
+	unsigned overlaps() const { return overlap_count; }
+
+private:
+	// an edge of a layer, a before b, with the polygons on its left and right
+	struct layer_edge
+	{
+		point a, b;
+		unsigned left, right;
+	};
+
+	// a piece of the arrangement from vertex u to vertex v, u < v, polygons on either side by layer
+	struct piece
+	{
+		unsigned u, v;
+		unsigned red_left, red_right;
+		unsigned blue_left, blue_right;
+		bool red, blue;			// lies on an edge of the layer
+	};
+
+	std::vector<point> points;
+	std::vector<half_edge> edges;
+	std::vector<face> face_list;
+	std::vector<unsigned> hole_start, hole_edges;	// by face
+	unsigned crossing_count;
+	unsigned overlap_count;
+
+	static void layer_edges(const std::vector<std::vector<double> > & polygons, std::vector<layer_edge> & out);
+	static std::vector<double> segments(const std::vector<layer_edge> &, const std::vector<bool> & shared,
+		std::vector<unsigned> & ids);
+	void cut_touching(std::vector<layer_edge> & red, std::vector<layer_edge> & blue,
+		std::vector<bool> & red_shared, std::vector<bool> & blue_shared);
+	static void vertices_inside(const std::vector<layer_edge> & from, const std::vector<layer_edge> & layer,
+		std::vector<std::vector<point> > & splits);
+	static void cut(std::vector<layer_edge> & layer, std::vector<std::vector<point> > & splits);
+
+	unsigned vertex(point) const;
+	void split(const std::vector<layer_edge> & layer, std::vector<std::vector<point> > & splits,
+		bool red, std::vector<piece> & pieces) const;
+	void link(const std::vector<piece> & pieces);
+	void make_faces(const std::vector<piece> & pieces);
+	unsigned face_left_of(unsigned vertex, const std::vector<unsigned> & strip_start,
+		const std::vector<unsigned> & strip_edges, double strip_y0, double strip_height) const;
+
+	Overlay(const Overlay &);
+	Overlay & operator = (const Overlay &);
+};
+
+#endif
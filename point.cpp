@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "point.h"
 
 bool point::operator < (const point other) const
@@ -39,4 +41,35 @@ std::ostream & operator << (std::ostream & out, const point & p)
 {
 	out << "[" << p.x << "," << p.y << "]";
 	return out;
+}
+
+bool meet(point p, point q, point a, point b, point & at)
+{
+	double pa = cross(p, q, a), pb = cross(p, q, b);
+	double ap = cross(a, b, p), aq = cross(a, b, q);
+	if ((pa > 0 && pb > 0) || (pa < 0 && pb < 0) || (ap > 0 && aq > 0) || (ap < 0 && aq < 0))
+		return false;
+	if (ap == 0 && aq == 0)
+		return false;
+
+	if (pa == 0)
+		at = a;
+	else if (pb == 0)
+		at = b;
+	else if (ap == 0)
+		at = p;
+	else if (aq == 0)
+		at = q;
+	else
+	{
+		double t = ap / (ap - aq);
+		at = point(p.x + t * (q.x - p.x), p.y + t * (q.y - p.y));
+
+		// rounding must not move it off a vertical or horizontal segment
+		at.x = std::max(at.x, std::max(std::min(p.x, q.x), std::min(a.x, b.x)));
+		at.x = std::min(at.x, std::min(std::max(p.x, q.x), std::max(a.x, b.x)));
+		at.y = std::max(at.y, std::max(std::min(p.y, q.y), std::min(a.y, b.y)));
+		at.y = std::min(at.y, std::min(std::max(p.y, q.y), std::max(a.y, b.y)));
+	}
+	return true;
 }
\ No newline at end of file
@@ -20,4 +20,15 @@ struct point
 	point(double x, double y) : x(x), y(y) {}
 };
 
+// +/- if C is on the left/right from AB
+inline double cross(point a, point b, point c)
+{
+	return (b.x-a.x)*(c.y-a.y) - (b.y-a.y)*(c.x-a.x);
+}
+
+/* the point where segments pq and ab meet, false if they do not or are
+   collinear; endpoints lying on the other segment are returned exactly, so
+   they merge with the vertex they are */
+bool meet(point p, point q, point a, point b, point & at);
+
 #endif
\ No newline at end of file
@@ -1,72 +1,163 @@
-#include <set>
-#include <iterator>
-#include <stdexcept>
+#include <algorithm>
 
 #include "quickhull.h"
+#include "bulk_input.h"
+#include "log.h"
 
 QuickHull::QuickHull(const std::vector<double> & coordinates)
 {
-	if (coordinates.size() < 2) 
+	BulkInput input(coordinates, 2);
+	input_flags = input.errors();
+	if (input.size() == 0)
 		return;
 
 	first_run = true;
 
-	// find left- and right-most points A and B
-	double min_x, max_x;
-	point p = point(coordinates.at(0), coordinates.at(1));
-	l = r = p; min_x = max_x = p.x;
-	for (unsigned i = 0; i < coordinates.size();) 
+	unsigned n = input.size();
+	const double * v = input.data();
+	init_points.x.resize(n);
+	init_points.y.resize(n);
+	for (unsigned i = 0; i < n; i++)
 	{
-		try
-		{
-			p.x = coordinates.at(i++);
-			p.y = coordinates.at(i++);
-		}
-		catch (std::out_of_range)
-		{
-			break;
-		}
-
-		if (p.x < min_x) 
-		{
-			min_x = p.x;
-			l = p;
-		} 
-		if (p.x > max_x) 
-		{
-			max_x = p.x;
-			r = p;
-		}
-		init_points.push_back(p);
+		init_points.x[i] = v[2*i];
+		init_points.y[i] = v[2*i+1];
 	}
 
-	// add A and B to convex hull 
+	// left- and right-most points A and B, the first ones on ties
+	const double * x = &init_points.x[0];
+	l = init_points.at((unsigned)(std::find(x, x + n, input.min_x()) - x));
+	r = init_points.at((unsigned)(std::find(x, x + n, input.max_x()) - x));
+
+	// add A and B to convex hull, the border starts as A -> B -> A
 	convex_hull.push_back(l);
-	std::cout << "Convex hull point found at " << l << "." << std::endl;
+	hull_next.push_back(0);
+	LOG(LOG_LEVEL_INFO, "Convex hull point found at " << l << ".");
 	if (init_points.size() <= 1)
 		return;
 
-	convex_hull.push_back(r);	
-	std::cout << "Convex hull point found at " << r << "." << std::endl;
+	insert_hull_point(r, 0);
+	LOG(LOG_LEVEL_INFO, "Convex hull point found at " << r << ".");
 	if (init_points.size() <= 2)
 		return;	
 
 	// divide points into lower and upper set
-	std::vector<point> upper_points;
-	std::vector<point> lower_points;
-	for(unsigned i = 0; i < init_points.size(); i++)
+	point_block upper_points;
+	point_block lower_points;
+	split_result split = split_farthest(init_points, 0, init_points.size(),
+		r, l, l, r, upper_points, lower_points);
+
+	//build_hull(r,l,split.far0,upper_points,0);
+	//build_hull(l,r,split.far1,lower_points,1);
+	queue.push(stack_item(l,r,split.far1,1));
+	queue.top().points.swap(lower_points);
+	queue.push(stack_item(r,l,split.far0,0));
+	queue.top().points.swap(upper_points);
+}
+
+QuickHull::QuickHull(const std::vector<double> & coordinates, ThreadPool & pool, unsigned cutoff)
+{
+	first_run = false;
+	BulkInput input(coordinates, 2);
+	input_flags = input.errors();
+	if (input.size() == 0)
+		return;
+
+	unsigned n = input.size();
+	const double * v = input.data();
+	init_points.x.resize(n);
+	init_points.y.resize(n);
+
+	// find left- and right-most points A and B, each slice keeps its first extremes
+	std::vector<point> slice_l(pool.size());
+	std::vector<point> slice_r(pool.size());
+	unsigned slices = pool.parallel_for(n, [&](unsigned slice, unsigned begin, unsigned end)
 	{
-		p = init_points.at(i);
-		if (point_location(r,l,p) > 0)
-			upper_points.push_back(p);
-		if (point_location(r,l,p) < 0)
-			lower_points.push_back(p);
+		point min_p = point(v[2*begin], v[2*begin+1]);
+		point max_p = min_p;
+		for (unsigned i = begin; i < end; i++)
+		{
+			point p = point(v[2*i], v[2*i+1]);
+			if (p.x < min_p.x)
+				min_p = p;
+			if (p.x > max_p.x)
+				max_p = p;
+			init_points.x[i] = p.x;
+			init_points.y[i] = p.y;
+		}
+		slice_l[slice] = min_p;
+		slice_r[slice] = max_p;
+	});
+
+	l = slice_l[0];
+	r = slice_r[0];
+	for (unsigned i = 1; i < slices; i++)
+	{
+		if (slice_l[i].x < l.x)
+			l = slice_l[i];
+		if (slice_r[i].x > r.x)
+			r = slice_r[i];
 	}
 
-	//build_hull(r,l,upper_points);
-	//build_hull(l,r,lower_points);
-	queue.push(stack_item(l,r,lower_points));
-	queue.push(stack_item(r,l,upper_points));
+	convex_hull.push_back(l);
+	hull_next.push_back(0);
+	if (init_points.size() <= 1)
+		return;
+	insert_hull_point(r, 0);
+	if (init_points.size() <= 2)
+		return;
+
+	/* divide points into lower and upper set, slices are joined in input order
+	   and the first farthest point of the earliest slice wins like in the serial pass */
+	std::vector<point_block> slice_upper(slices);
+	std::vector<point_block> slice_lower(slices);
+	std::vector<split_result> slice_split(slices);
+	pool.parallel_for(n, [&](unsigned slice, unsigned begin, unsigned end)
+	{
+		slice_split[slice] = split_farthest(init_points, begin, end,
+			r, l, l, r, slice_upper[slice], slice_lower[slice]);
+	});
+
+	point_block upper_points;
+	point_block lower_points;
+	split_result split = slice_split[0];
+	for (unsigned i = 0; i < slices; i++)
+	{
+		upper_points.x.insert(upper_points.x.end(), slice_upper[i].x.begin(), slice_upper[i].x.end());
+		upper_points.y.insert(upper_points.y.end(), slice_upper[i].y.begin(), slice_upper[i].y.end());
+		lower_points.x.insert(lower_points.x.end(), slice_lower[i].x.begin(), slice_lower[i].x.end());
+		lower_points.y.insert(lower_points.y.end(), slice_lower[i].y.begin(), slice_lower[i].y.end());
+		if (slice_split[i].area0 > split.area0)
+		{
+			split.area0 = slice_split[i].area0;
+			split.far0 = slice_split[i].far0;
+		}
+		if (slice_split[i].area1 > split.area1)
+		{
+			split.area1 = slice_split[i].area1;
+			split.far1 = slice_split[i].far1;
+		}
+	}
+
+	std::vector<point> upper_hull;
+	std::vector<point> lower_hull;
+	TaskGroup group;
+	pool.run(group, [&]()
+	{
+		parallel_build_hull(r, l, split.far0, upper_points, upper_hull, pool, cutoff);
+	});
+	parallel_build_hull(l, r, split.far1, lower_points, lower_hull, pool, cutoff);
+	pool.wait(group);
+
+	// both chains come out in order from A to B of their subproblem
+	convex_hull.pop_back();
+	convex_hull.insert(convex_hull.end(), upper_hull.rbegin(), upper_hull.rend());
+	convex_hull.push_back(r);
+	convex_hull.insert(convex_hull.end(), lower_hull.rbegin(), lower_hull.rend());
+
+	hull_next.resize(convex_hull.size());
+	for (unsigned i = 0; i < convex_hull.size(); i++)
+		hull_next[i] = i + 1;
+	hull_next.back() = 0;
 }
 
 // step-by-step processing, returns 1 when done
@@ -78,11 +169,11 @@ bool QuickHull::next_step()
 	if (first_run)
 	{
 		first_run = false;
-		convex_hull.clear();
 		return false;
 	}
 
-	stack_item item = queue.top();
+	stack_item item = stack_item(queue.top().a, queue.top().b, queue.top().c, queue.top().after);
+	item.points.swap(queue.top().points);
 	processed.push_back(item.a.x);
 	processed.push_back(item.a.y);
 	processed.push_back(item.b.x);
@@ -97,85 +188,59 @@ bool QuickHull::next_step()
 	if (item.points.size() == 0)
 		return false;
 
-	std::vector<point> ac_points;
-	std::vector<point> cb_points;
+	point_block ac_points;
+	point_block cb_points;
 
-	point c = fartherest_point(item.a, item.b, item.points);
-	convex_hull.push_back(c);
+	point c = item.c;
+	unsigned c_index = insert_hull_point(c, item.after);
 	triangle.push_back(c.x);
 	triangle.push_back(c.y);
-	std::cout << "Convex hull point found at " << c << "." << std::endl;
-
-	point p;
-	for (unsigned i = 0; i < item.points.size(); i++)
-	{
-		p = item.points.at(i);
-		if (point_location(item.a,c,p) > 0)
-			ac_points.push_back(p);
-		if (point_location(c,item.b,p) > 0)
-			cb_points.push_back(p);
-	}		
-	queue.push(stack_item(c, item.b, cb_points));
-	queue.push(stack_item(item.a, c, ac_points));
+	LOG(LOG_LEVEL_INFO, "Convex hull point found at " << c << ".");
+
+	// split the points and find the next farthest points in one pass
+	split_result split = split_farthest(item.points, 0, item.points.size(),
+		item.a, c, c, item.b, ac_points, cb_points);
+	queue.push(stack_item(c, item.b, split.far1, item.after));
+	queue.top().points.swap(cb_points);
+	queue.push(stack_item(item.a, c, split.far0, c_index));
+	queue.top().points.swap(ac_points);
 	return false;
 }
 
-/* too complicated process of creating vector containing
-   convex hull points in the right order for further easy rendering */
+// walks the border from A, upper chain first
 std::vector<double> QuickHull::get_convex_hull() const
 {
 	std::vector<double> hull;
-	std::set<point> upper;
-	std::set<point> lower;
+	if (convex_hull.empty())
+		return hull;
 
-	point p;
-	for(unsigned i = 0; i < convex_hull.size(); i++)
+	hull.reserve(2*convex_hull.size());
+	unsigned i = 0;
+	do
 	{
-		p = convex_hull.at(i);
-		if (point_location(r,l,p) > 0)
-			upper.insert(p);
-		if (point_location(r,l,p) < 0)
-			lower.insert(p);
-	}
-
-	hull.push_back(l.x);
-	hull.push_back(l.y);
-
-	std::set<point>::const_iterator it;
-	for(it = upper.begin(); it != upper.end(); ++it)
-	{
-		hull.push_back(it->x);
-		hull.push_back(it->y);
-	}
-
-	hull.push_back(r.x);
-	hull.push_back(r.y);
-
-	std::set<point>::const_reverse_iterator rit;
-	for(rit = lower.rbegin(); rit != lower.rend(); ++rit)
-	{
-		hull.push_back(rit->x);
-		hull.push_back(rit->y);
-	}
+		hull.push_back(convex_hull[i].x);
+		hull.push_back(convex_hull[i].y);
+		i = hull_next[i];
+	} while (i != 0);
 	return hull;
 }
 
-std::vector<double> QuickHull::current_points()
+std::vector<double> QuickHull::current_points() const
 {
 	std::vector<double> curr_points;
 	if (!queue.empty())
 	{
-		std::vector<point> points = queue.top().points;
+		const point_block & points = queue.top().points;
 		for (unsigned i = 0; i < points.size(); i++)
 		{
-			curr_points.push_back(points.at(i).x);
-			curr_points.push_back(points.at(i).y);
+			curr_points.push_back(points.x[i]);
+			curr_points.push_back(points.y[i]);
 		}
 	}
 	return curr_points;
 }
 
-std::vector<double> QuickHull::current_line()
+std::vector<double> QuickHull::current_line() const
 {
 	std::vector<double> curr_line;
 	if (!queue.empty())
@@ -197,58 +262,59 @@ double QuickHull::point_location(point a, point b, point p) const
 	return (a.x-b.x)*(p.y-b.y) - (p.x-b.x)*(a.y-b.y);
 }
 
-// distance of point P from AB
-double QuickHull::distance(point a, point b, point p) const
+// adds P to the border right after convex_hull[after], returns its index
+unsigned QuickHull::insert_hull_point(point p, unsigned after)
 {
-	double x, y, u;
-	u = ((p.x-a.x)*(b.x-a.x) + (p.y-a.y)*(b.y-a.y)) / ((b.x-a.x)*(b.x-a.x) + (b.y-a.y)*(b.y-a.y));
-	x = a.x + u*(b.x-a.x);
-	y = a.y + u*(b.y-a.y);
-	return ((x-p.x)*(x-p.x) + (y-p.y)*(y-p.y));
+	unsigned index = (unsigned)convex_hull.size();
+	convex_hull.push_back(p);
+	hull_next.push_back(hull_next[after]);
+	hull_next[after] = index;
+	return index;
 }
 
-// find most distant point from AB
-point QuickHull::fartherest_point(point a, point b, const std::vector<point> & points) const
+void QuickHull::build_hull(point a, point b, point c, const point_block & points, unsigned after)
 {
-	point max_point;
-	double max_distance;
-	double point_distance;
+	if (points.size() == 0) 
+		return;
 
-	point_distance = max_distance = 0.0;
-	max_point.x = max_point.y = 0.0;
-	for (unsigned i = 0; i < points.size(); i++)
-	{
-		point_distance = distance(a, b, points.at(i));
-		if (point_distance > max_distance)
-		{
-			max_distance = point_distance;
-			max_point = points.at(i);
-		}
-	}
-	return max_point;
+	point_block ac_points;
+	point_block cb_points;
+
+	unsigned c_index = insert_hull_point(c, after);
+	//std::cout << "Convex hull point found at " << c << "." << std::endl;
+
+	split_result split = split_farthest(points, 0, points.size(), a, c, c, b, ac_points, cb_points);
+	build_hull(a, c, split.far0, ac_points, c_index);
+	build_hull(c, b, split.far1, cb_points, after);
 }
 
-void QuickHull::build_hull(point a, point b, const std::vector<point> & points)
+/* same as build_hull, but the points found are appended to hull in order from A to B
+   and the (C,B) half is spawned as a task when there are enough points */
+void QuickHull::parallel_build_hull(point a, point b, point c, const point_block & points,
+	std::vector<point> & hull, ThreadPool & pool, unsigned cutoff) const
 {
-	if (points.size() == 0) 
+	if (points.size() == 0)
 		return;
 
-	std::vector<point> ac_points;
-	std::vector<point> cb_points;
+	point_block ac_points;
+	point_block cb_points;
 
-	point c = fartherest_point(a, b, points);
-	convex_hull.push_back(c);
-	//std::cout << "Convex hull point found at " << c << "." << std::endl;
+	split_result split = split_farthest(points, 0, points.size(), a, c, c, b, ac_points, cb_points);
 
-	point p;
-	for (unsigned i = 0; i < points.size(); i++)
+	if (points.size() < cutoff)
 	{
-		p = points.at(i);
-		if (point_location(a,c,p) > 0)
-			ac_points.push_back(p);
-		if (point_location(c,b,p) > 0)
-			cb_points.push_back(p);
+		parallel_build_hull(a, c, split.far0, ac_points, hull, pool, cutoff);
+		hull.push_back(c);
+		parallel_build_hull(c, b, split.far1, cb_points, hull, pool, cutoff);
+		return;
 	}
-	build_hull(a, c, ac_points);
-	build_hull(c, b, cb_points);
+
+	std::vector<point> cb_hull;
+	TaskGroup group;
+	pool.run(group, [&]() { parallel_build_hull(c, b, split.far1, cb_points, cb_hull, pool, cutoff); });
+	parallel_build_hull(a, c, split.far0, ac_points, hull, pool, cutoff);
+	pool.wait(group);
+
+	hull.push_back(c);
+	hull.insert(hull.end(), cb_hull.begin(), cb_hull.end());
 }
\ No newline at end of file
@@ -5,42 +5,62 @@
 #include <stack>
 
 #include "point.h"
+#include "hull_kernel.h"
+#include "thread_pool.h"
+
+// subproblems smaller than this are not split into parallel tasks
+const unsigned PARALLEL_CUTOFF = 4096;
 
 class QuickHull
 {
 public: 
 	QuickHull(){}
 	QuickHull(const std::vector<double> &);
+
+	// computes the whole hull at once on the given pool, next_step() is then done
+	QuickHull(const std::vector<double> &, ThreadPool &, unsigned cutoff = PARALLEL_CUTOFF);
 	bool next_step();
+
+	/* hull points found so far, clockwise from the leftmost point: upper chain, then
+	   the rightmost point, then lower chain; the order of the other hull engines */
 	std::vector<double> get_convex_hull() const;
-	std::vector<double> current_points();
-	std::vector<double> current_line();
-	std::vector<double> processed_lines() { return processed; }
-	std::vector<double> processed_triangle() { return triangle; }
+	std::vector<double> current_points() const;
+	std::vector<double> current_line() const;
+	const std::vector<double> & processed_lines() const { return processed; }
+	const std::vector<double> & processed_triangle() const { return triangle; }
+
+	// input_error flags of the points
+	unsigned input_errors() const { return input_flags; }
 
 private:
-	std::vector<point> convex_hull;	
-	std::vector<point> init_points;
+	std::vector<point> convex_hull;		// hull points in the order they were found
+	std::vector<unsigned> hull_next;	// index of the next point on the hull border
+	point_block init_points;
 	std::vector<double> processed;
 	std::vector<double> triangle;
 	point l,r;
+	unsigned input_flags;
 
+	/* C is the point of points farthest from AB, found when the parent was split,
+	   it belongs on the border right after convex_hull[after] */
 	struct stack_item
 	{
-		point a, b;
-		std::vector<point> points;
+		point a, b, c;
+		unsigned after;
+		point_block points;
 
-		stack_item(point a, point b, std::vector<point> points) 
-			: a(a), b(b), points(points) {}
+		stack_item(point a, point b, point c, unsigned after) 
+			: a(a), b(b), c(c), after(after) {}
 	};
 
 	std::stack<stack_item> queue;
 	bool first_run;
 
 	double point_location(point a, point b, point p) const;
-	double distance(point a, point b, point p) const;
-	point fartherest_point(point, point, const std::vector<point> & ) const;
-	void build_hull(point, point, const std::vector<point> & );
+	unsigned insert_hull_point(point, unsigned);
+	void build_hull(point, point, point, const point_block &, unsigned);
+	void parallel_build_hull(point, point, point, const point_block &,
+		std::vector<point> &, ThreadPool &, unsigned) const;
 };
 
 #endif
\ No newline at end of file
@@ -11,13 +11,19 @@ segment::segment(double x1, double y1, double x2, double y2, segment_color color
 	right.y = x1 < x2 ? y2 : y1;
 
 	y_sweep = 0.0;
+	y_tie = 0.0;
 	x0 = x1;
+	id = 0;
+	chain = 0;
 }
 
 segment::segment(endpoint left, endpoint right, segment_color color) : left(left), right(right), color(color)
 {
 	y_sweep = 0.0;
+	y_tie = 0.0;
 	x0 = left.x;
+	id = 0;
+	chain = 0;
 }
 
 bool segment::operator < (const segment &other) const 
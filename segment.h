@@ -15,7 +15,10 @@ struct segment
 	endpoint right;
 	segment_color color;
 	double y_sweep;
+	double y_tie;		// orders segments with the same y_sweep, see SweepStatus
 	double x0;
+	unsigned id;		// position among the input segments of its color
+	unsigned chain;		// chain of polyline edges it moves along, see TrapezoidSweep
 
 	segment() {	segment(0.0, 0.0, 0.0, 0.0, RED); }
 	segment(double, double, double, double, segment_color);
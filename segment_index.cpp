@@ -0,0 +1,485 @@
+#include <algorithm>
+#include <random>
+
+#include "segment_index.h"
+#include "point.h"
+
+const unsigned SegmentIndex::NONE;
+
+SegmentIndex::SegmentIndex() : consistent(true)
+{
+	add_trapezoid(NONE, NONE, NONE, NONE);
+}
+
+SegmentIndex::SegmentIndex(const std::vector<double> & blue_endpoints, unsigned seed) : consistent(true)
+{
+	add_trapezoid(NONE, NONE, NONE, NONE);
+
+	std::vector<unsigned> order;
+	for (unsigned i = 0; i + 3 < blue_endpoints.size(); i += 4)
+	{
+		point a(blue_endpoints[i], blue_endpoints[i + 1]);
+		point b(blue_endpoints[i + 2], blue_endpoints[i + 3]);
+		if (b < a)
+			std::swap(a, b);
+		if (a != b)
+			order.push_back(i / 4);
+		points.push_back(a);
+		points.push_back(b);
+	}
+
+	// random order keeps the search structure O(log n) deep in expectation
+	std::mt19937 random(seed);
+	std::shuffle(order.begin(), order.end(), random);
+
+	std::vector<unsigned> sequence;
+	std::vector<bool> dead(1, false);
+	for (unsigned i = 0; i < order.size() && consistent; i++)
+		consistent = insert(order[i], sequence, dead);
+
+	compact(dead);
+	link_segments();
+	link_vertices();
+}
+
+unsigned SegmentIndex::add_trapezoid(unsigned top, unsigned bottom, unsigned leftp, unsigned rightp)
+{
+	trapezoid t;
+	t.top = top;
+	t.bottom = bottom;
+	t.leftp = leftp;
+	t.rightp = rightp;
+	t.ul = t.ll = t.ur = t.lr = NONE;
+	t.leaf = (unsigned)nodes.size();
+	traps.push_back(t);
+
+	node leaf;
+	leaf.kind = LEAF;
+	leaf.id = (unsigned)traps.size() - 1;
+	leaf.left = leaf.right = NONE;
+	nodes.push_back(leaf);
+	return leaf.id;
+}
+
+/* splits the trapezoids crossed by the segment into parts above and below it,
+   parts are merged where the segment cuts a wall off, the crossed trapezoids
+   are marked dead and their leaves become the nodes that tell the parts apart */
+bool SegmentIndex::insert(unsigned s, std::vector<unsigned> & sequence, std::vector<bool> & dead)
+{
+	point p = points[2*s], q = points[2*s + 1];
+
+	// trapezoids crossed from left to right, the segment passes below or above each wall point
+	sequence.clear();
+	sequence.push_back(locate(p, q));
+	for (;;)
+	{
+		const trapezoid & t = traps[sequence.back()];
+		if (t.rightp == NONE || !(points[t.rightp] < q))
+			break;
+		unsigned next = cross(p, q, points[t.rightp]) < 0 ? t.ur : t.lr;
+		if (next == NONE)
+			return false;
+		sequence.push_back(next);
+	}
+	unsigned k = (unsigned)sequence.size() - 1;
+
+	// parts above and below, a wall point below the segment merges the parts above and the other way round
+	std::vector<unsigned> upper(k + 1), lower(k + 1);
+	for (unsigned j = 0; j <= k; j++)
+	{
+		unsigned d = sequence[j];
+		unsigned wall = j == 0 ? 2*s : traps[sequence[j - 1]].rightp;
+		bool wall_below = j > 0 && cross(p, q, points[wall]) < 0;
+
+		if (j == 0 || !wall_below)
+		{
+			upper[j] = add_trapezoid(traps[d].top, s, wall, NONE);
+			if (j > 0)
+				traps[upper[j - 1]].rightp = wall;
+		}
+		else
+			upper[j] = upper[j - 1];
+
+		if (j == 0 || wall_below)
+		{
+			lower[j] = add_trapezoid(s, traps[d].bottom, wall, NONE);
+			if (j > 0)
+				traps[lower[j - 1]].rightp = wall;
+		}
+		else
+			lower[j] = lower[j - 1];
+	}
+	traps[upper[k]].rightp = 2*s + 1;
+	traps[lower[k]].rightp = 2*s + 1;
+
+	// left end: a new trapezoid left of p, or p was there already and its wall is split
+	trapezoid first = traps[sequence[0]];
+	unsigned left_part = NONE;
+	if (first.leftp == NONE || points[first.leftp] != p)
+	{
+		left_part = add_trapezoid(first.top, first.bottom, first.leftp, 2*s);
+		trapezoid & a = traps[left_part];
+		a.ul = first.ul;
+		a.ll = first.ll;
+		a.ur = upper[0];
+		a.lr = lower[0];
+		if (first.ul != NONE)
+			traps[first.ul].ur = left_part;
+		if (first.ll != NONE)
+			traps[first.ll].lr = left_part;
+		traps[upper[0]].ul = left_part;
+		traps[lower[0]].ll = left_part;
+	}
+	else
+	{
+		traps[upper[0]].ul = first.ul;
+		traps[lower[0]].ll = first.ll;
+		if (first.ul != NONE)
+			traps[first.ul].ur = upper[0];
+		if (first.ll != NONE)
+			traps[first.ll].lr = lower[0];
+	}
+
+	// right end, the same
+	trapezoid last = traps[sequence[k]];
+	unsigned right_part = NONE;
+	if (last.rightp == NONE || points[last.rightp] != q)
+	{
+		right_part = add_trapezoid(last.top, last.bottom, 2*s + 1, last.rightp);
+		trapezoid & b = traps[right_part];
+		b.ur = last.ur;
+		b.lr = last.lr;
+		b.ul = upper[k];
+		b.ll = lower[k];
+		if (last.ur != NONE)
+			traps[last.ur].ul = right_part;
+		if (last.lr != NONE)
+			traps[last.lr].ll = right_part;
+		traps[upper[k]].ur = right_part;
+		traps[lower[k]].lr = right_part;
+	}
+	else
+	{
+		traps[upper[k]].ur = last.ur;
+		traps[lower[k]].lr = last.lr;
+		if (last.ur != NONE)
+			traps[last.ur].ul = upper[k];
+		if (last.lr != NONE)
+			traps[last.lr].ll = lower[k];
+	}
+
+	// walls between the crossed trapezoids, the part on the far side of the wall point is gone
+	for (unsigned j = 0; j < k; j++)
+	{
+		trapezoid d = traps[sequence[j]], e = traps[sequence[j + 1]];
+		if (cross(p, q, points[d.rightp]) < 0)
+		{
+			traps[lower[j]].lr = d.lr;
+			traps[lower[j]].ur = lower[j + 1];
+			traps[lower[j + 1]].ul = lower[j];
+			traps[lower[j + 1]].ll = e.ll;
+			if (d.lr != NONE)
+				traps[d.lr].ll = lower[j];
+			if (e.ll != NONE)
+				traps[e.ll].lr = lower[j + 1];
+		}
+		else
+		{
+			traps[upper[j]].ur = d.ur;
+			traps[upper[j]].lr = upper[j + 1];
+			traps[upper[j + 1]].ll = upper[j];
+			traps[upper[j + 1]].ul = e.ul;
+			if (d.ur != NONE)
+				traps[d.ur].ul = upper[j];
+			if (e.ul != NONE)
+				traps[e.ul].ur = upper[j + 1];
+		}
+	}
+
+	// leaves of the crossed trapezoids become the nodes deciding between the new ones
+	for (unsigned j = 0; j <= k; j++)
+	{
+		node decision;
+		decision.kind = Y_NODE;
+		decision.id = s;
+		decision.left = traps[upper[j]].leaf;
+		decision.right = traps[lower[j]].leaf;
+
+		if (j == k && right_part != NONE)
+		{
+			nodes.push_back(decision);
+			decision.kind = X_NODE;
+			decision.id = 2*s + 1;
+			decision.left = (unsigned)nodes.size() - 1;
+			decision.right = traps[right_part].leaf;
+		}
+		if (j == 0 && left_part != NONE)
+		{
+			nodes.push_back(decision);
+			decision.kind = X_NODE;
+			decision.id = 2*s;
+			decision.left = traps[left_part].leaf;
+			decision.right = (unsigned)nodes.size() - 1;
+		}
+		nodes[traps[sequence[j]].leaf] = decision;
+	}
+
+	dead.resize(traps.size(), false);
+	for (unsigned j = 0; j <= k; j++)
+		dead[sequence[j]] = true;
+	return true;
+}
+
+// drops the dead trapezoids and renumbers the rest
+void SegmentIndex::compact(const std::vector<bool> & dead)
+{
+	std::vector<unsigned> number(traps.size(), NONE);
+	unsigned live = 0;
+	for (unsigned i = 0; i < traps.size(); i++)
+	{
+		if (i >= dead.size() || !dead[i])
+			number[i] = live++;
+	}
+
+	for (unsigned i = 0; i < traps.size(); i++)
+	{
+		if (number[i] == NONE)
+			continue;
+		trapezoid t = traps[i];
+		unsigned * neighbors[] = { &t.ul, &t.ll, &t.ur, &t.lr };
+		for (unsigned k = 0; k < 4; k++)
+		{
+			if (*neighbors[k] != NONE)
+				*neighbors[k] = number[*neighbors[k]];
+		}
+		nodes[t.leaf].id = number[i];
+		traps[number[i]] = t;
+	}
+	traps.resize(live);
+	std::vector<trapezoid>(traps).swap(traps);
+}
+
+// lists of the trapezoids along both sides of every segment, for stepping across it
+void SegmentIndex::link_segments()
+{
+	unsigned count = size();
+	above_start.assign(count + 1, 0);
+	below_start.assign(count + 1, 0);
+	for (unsigned i = 0; i < traps.size(); i++)
+	{
+		if (traps[i].bottom != NONE)
+			above_start[traps[i].bottom + 1]++;
+		if (traps[i].top != NONE)
+			below_start[traps[i].top + 1]++;
+	}
+	for (unsigned s = 0; s < count; s++)
+	{
+		above_start[s + 1] += above_start[s];
+		below_start[s + 1] += below_start[s];
+	}
+
+	above.resize(above_start[count]);
+	below.resize(below_start[count]);
+	std::vector<unsigned> above_fill(above_start.begin(), above_start.end() - 1);
+	std::vector<unsigned> below_fill(below_start.begin(), below_start.end() - 1);
+	for (unsigned i = 0; i < traps.size(); i++)
+	{
+		if (traps[i].bottom != NONE)
+			above[above_fill[traps[i].bottom]++] = i;
+		if (traps[i].top != NONE)
+			below[below_fill[traps[i].top]++] = i;
+	}
+
+	struct left_to_right
+	{
+		const SegmentIndex * index;
+		bool operator () (unsigned a, unsigned b) const
+		{
+			return index->points[index->traps[a].leftp] < index->points[index->traps[b].leftp];
+		}
+	} order = { this };
+	for (unsigned s = 0; s < count; s++)
+	{
+		std::sort(above.begin() + above_start[s], above.begin() + above_start[s + 1], order);
+		std::sort(below.begin() + below_start[s], below.begin() + below_start[s + 1], order);
+	}
+}
+
+void SegmentIndex::link_vertices()
+{
+	std::vector<std::pair<point, unsigned> > ends;
+	for (unsigned s = 0; s < size(); s++)
+	{
+		if (points[2*s] != points[2*s + 1])
+		{
+			ends.push_back(std::make_pair(points[2*s], s));
+			ends.push_back(std::make_pair(points[2*s + 1], s));
+		}
+	}
+	std::sort(ends.begin(), ends.end());
+
+	for (unsigned i = 0; i < ends.size(); i++)
+	{
+		if (i == 0 || ends[i - 1].first != ends[i].first)
+		{
+			vertices.push_back(ends[i].first);
+			vertex_start.push_back(i);
+		}
+		vertex_segments.push_back(ends[i].second);
+	}
+	vertex_start.push_back((unsigned)ends.size());
+}
+
+unsigned SegmentIndex::locate(point p, point w) const
+{
+	unsigned n = 0;
+	while (nodes[n].kind != LEAF)
+	{
+		const node & d = nodes[n];
+		if (d.kind == X_NODE)
+			n = p < points[d.id] ? d.left : d.right;
+		else
+		{
+			point a = points[2*d.id], b = points[2*d.id + 1];
+			double side = cross(a, b, p);
+			if (side == 0)
+				side = cross(a, b, w);
+			n = side < 0 ? d.right : d.left;
+		}
+	}
+	return nodes[n].id;
+}
+
+unsigned SegmentIndex::beside(const std::vector<unsigned> & start, const std::vector<unsigned> & list,
+	unsigned s, point p) const
+{
+	unsigned first = start[s], last = start[s + 1];
+	while (last - first > 1)
+	{
+		unsigned middle = (first + last) / 2;
+		if (p < points[traps[list[middle]].leftp])
+			last = middle;
+		else
+			first = middle;
+	}
+	return list[first];
+}
+
+void SegmentIndex::report_vertex(point v, point p, point q, std::vector<double> & out) const
+{
+	std::vector<point>::const_iterator found = std::lower_bound(vertices.begin(), vertices.end(), v);
+	if (found == vertices.end() || *found != v)
+		return;
+
+	unsigned i = (unsigned)(found - vertices.begin());
+	for (unsigned k = vertex_start[i]; k < vertex_start[i + 1]; k++)
+	{
+		unsigned s = vertex_segments[k];
+		if (cross(p, q, points[2*s]) != 0 || cross(p, q, points[2*s + 1]) != 0)
+		{
+			out.push_back(v.x);
+			out.push_back(v.y);
+		}
+	}
+}
+
+/* follows red segment pq through the map: a blue segment is reported when it
+   meets pq inside a trapezoid it bounds, pq leaves a trapezoid by crossing its
+   top or bottom or through its right wall. meetings at blue endpoints are left to
+   report_vertex, once for p and q and for every wall point lying on pq, so a
+   point shared by several blue segments is reported for each of them */
+void SegmentIndex::walk(point p, point q, std::vector<double> & out) const
+{
+	unsigned current = locate(p, q);
+	point entry = p;
+	unsigned crossed = NONE;
+	report_vertex(p, p, q, out);
+
+	while (current != NONE)
+	{
+		const trapezoid & t = traps[current];
+		bool ends = t.rightp == NONE || !(points[t.rightp] < q);
+		point exit = ends ? q : points[t.rightp];
+
+		unsigned next = NONE, through = NONE;
+		point at;
+		unsigned sides[] = { t.top, t.bottom };
+		for (unsigned i = 0; i < 2; i++)
+		{
+			unsigned s = sides[i];
+			point meeting;
+			if (s == NONE || s == crossed || !meet(p, q, points[2*s], points[2*s + 1], meeting))
+				continue;
+			if (meeting == points[2*s] || meeting == points[2*s + 1])
+				continue;
+			// a meeting on the wall belongs to the next trapezoid unless pq ends there
+			if (meeting < entry || exit < meeting || (meeting == exit && !ends))
+				continue;
+			out.push_back(meeting.x);
+			out.push_back(meeting.y);
+
+			// q on the far side: pq leaves through this segment before the wall
+			double side = cross(points[2*s], points[2*s + 1], q);
+			if (meeting < exit && (i == 0 ? side > 0 : side < 0))
+			{
+				next = i == 0 ? beside(above_start, above, s, meeting) : beside(below_start, below, s, meeting);
+				at = meeting;
+				through = s;
+			}
+		}
+
+		if (next != NONE)
+		{
+			current = next;
+			entry = at;
+			crossed = through;
+			continue;
+		}
+		if (ends)
+		{
+			report_vertex(q, p, q, out);
+			break;
+		}
+
+		point wall = points[t.rightp];
+		double side = cross(p, q, wall);
+		if (side < 0)
+			current = t.ur;
+		else if (side > 0)
+			current = t.lr;
+		else
+		{
+			report_vertex(wall, p, q, out);
+			current = locate(wall, q);
+		}
+		entry = wall;
+		crossed = NONE;
+	}
+}
+
+std::vector<double> SegmentIndex::intersections(const std::vector<double> & red_endpoints) const
+{
+	std::vector<double> out;
+	for (unsigned i = 0; i + 3 < red_endpoints.size(); i += 4)
+	{
+		point p(red_endpoints[i], red_endpoints[i + 1]);
+		point q(red_endpoints[i + 2], red_endpoints[i + 3]);
+		if (q < p)
+			std::swap(p, q);
+		if (p != q)
+			walk(p, q, out);
+	}
+	return out;
+}
+
+std::vector<std::vector<double> > SegmentIndex::intersections(const std::vector<std::vector<double> > & red_sets,
+	ThreadPool & pool) const
+{
+	std::vector<std::vector<double> > results(red_sets.size());
+	pool.parallel_for((unsigned)red_sets.size(), [&](unsigned, unsigned begin, unsigned end)
+	{
+		for (unsigned i = begin; i < end; i++)
+			results[i] = intersections(red_sets[i]);
+	});
+	return results;
+}
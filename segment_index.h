@@ -0,0 +1,95 @@
+#ifndef SEGMENT_INDEX_H_
+#define SEGMENT_INDEX_H_
+
+#include <vector>
+
+#include "point.h"
+#include "thread_pool.h"
+
+/* trapezoidal map of a fixed blue set with its search structure, built once by
+   randomized incremental construction in O(n log n) expected time and O(n) space
+   and then queried with any number of red sets: a red segment is located in
+   O(log n) expected time and walked through the trapezoids it crosses, a query of
+   k red segments costs O(k log n) plus the trapezoids visited plus the output.
+   blue segments must not cross each other, as in the trapezoid sweep; queries
+   do not change the index and can run from many threads at once.
+   points are ordered like point::operator <, so vertical segments need no nudging */
+class SegmentIndex
+{
+public:
+	SegmentIndex();
+
+	// x1,y1,x2,y2 per blue segment, the seed picks the insertion order
+	SegmentIndex(const std::vector<double> & blue_endpoints, unsigned seed = 1);
+
+	/* x,y of every point where a red segment meets a blue one, in the format of
+	   TrapezoidSweep::intersections(); collinear overlaps are not reported */
+	std::vector<double> intersections(const std::vector<double> & red_endpoints) const;
+
+	// one result per red set, the sets are spread over the pool
+	std::vector<std::vector<double> > intersections(const std::vector<std::vector<double> > & red_sets,
+		ThreadPool &) const;
+
+	// false if the blue segments were found to cross, the index is then incomplete
+	bool good() const { return consistent; }
+
+	unsigned size() const { return (unsigned)(points.size() / 2); }
+	unsigned trapezoid_count() const { return (unsigned)traps.size(); }
+
+private:
+	static const unsigned NONE = 0xffffffff;
+
+	// bounded by segments top and bottom and the vertical walls through points leftp and rightp
+	struct trapezoid
+	{
+		unsigned top, bottom;		// segments, NONE if unbounded
+		unsigned leftp, rightp;		// points, NONE if unbounded
+		unsigned ul, ll, ur, lr;	// neighbors through the walls, u* share top, l* share bottom
+		unsigned leaf;			// node of the search structure
+	};
+
+	enum node_kind { X_NODE, Y_NODE, LEAF };
+
+	/* X_NODE: point id, left and right child; Y_NODE: segment id, child above and
+	   below (left and right); LEAF: trapezoid id */
+	struct node
+	{
+		node_kind kind;
+		unsigned id;
+		unsigned left, right;
+	};
+
+	std::vector<point> points;		// segment i goes from points[2i] to points[2i+1], left to right
+	std::vector<trapezoid> traps;
+	std::vector<node> nodes;		// nodes[0] is the root
+	bool consistent;
+
+	// trapezoids above / below each segment, sorted from left to right
+	std::vector<unsigned> above_start, above;
+	std::vector<unsigned> below_start, below;
+
+	// distinct endpoints and the segments ending at each
+	std::vector<point> vertices;
+	std::vector<unsigned> vertex_start, vertex_segments;
+
+	unsigned add_trapezoid(unsigned top, unsigned bottom, unsigned leftp, unsigned rightp);
+	bool insert(unsigned segment, std::vector<unsigned> & sequence, std::vector<bool> & dead);
+	void compact(const std::vector<bool> & dead);
+	void link_segments();
+	void link_vertices();
+
+	/* trapezoid holding the point a tiny step from p towards w, which breaks ties
+	   when p lies on a wall or a segment */
+	unsigned locate(point p, point w) const;
+
+	// trapezoid above/below segment s holding the point a tiny step right of p
+	unsigned beside(const std::vector<unsigned> & start, const std::vector<unsigned> & list,
+		unsigned s, point p) const;
+
+	// reports the segments ending at v unless they run along pq
+	void report_vertex(point v, point p, point q, std::vector<double> & out) const;
+
+	void walk(point p, point q, std::vector<double> & out) const;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+/* bounded lock-free queue for exactly one producer thread and one consumer
+   thread: the producer only writes tail, the consumer only writes head, a slot
+   is handed over by the release store of the index that covers it */
+template <typename T>
+class SpscQueue
+{
+public:
+	// the capacity is rounded up to a power of two
+	explicit SpscQueue(unsigned capacity) : head(0), tail(0)
+	{
+		size_t slots = 2;
+		while (slots < capacity)
+			slots *= 2;
+		ring.resize(slots);
+		mask = slots - 1;
+	}
+
+	// producer, false if the queue is full
+	bool push(const T & value)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) > mask)
+			return false;
+		ring[t & mask] = value;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer, false if the queue is empty; the slot is cleared so it does not keep the value alive
+	bool pop(T & value)
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire))
+			return false;
+		value = ring[h & mask];
+		ring[h & mask] = T();
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	// exact from either side only while the other side is idle
+	bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+	unsigned capacity() const { return (unsigned)ring.size(); }
+
+private:
+	std::vector<T> ring;
+	size_t mask;
+
+	// apart, so the two threads do not share a cache line
+	alignas(64) std::atomic<size_t> head;	// next slot to pop
+	alignas(64) std::atomic<size_t> tail;	// next slot to push
+
+	SpscQueue(const SpscQueue &);
+	SpscQueue & operator = (const SpscQueue &);
+};
+
+#endif
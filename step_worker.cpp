@@ -0,0 +1,90 @@
+#include <chrono>
+
+#include "step_worker.h"
+#include "log.h"
+
+StepWorker::StepWorker(unsigned capacity)
+	: snapshots(capacity), stopping(false), skipping(false), algorithm(TRAPEZOID)
+{
+}
+
+void StepWorker::start(mode m, const std::vector<double> & blue, const std::vector<double> & red,
+	const std::vector<double> & hull_points)
+{
+	stop();
+	algorithm = m;
+	blue_endpoints = std::make_shared<const std::vector<double> >(blue);
+	red_endpoints = std::make_shared<const std::vector<double> >(red);
+	points = std::make_shared<const std::vector<double> >(hull_points);
+	published = history_mark();
+	worker = std::thread(&StepWorker::run, this);
+}
+
+void StepWorker::stop()
+{
+	stopping.store(true);
+	if (worker.joinable())
+		worker.join();
+	stopping.store(false);
+
+	std::shared_ptr<const frame> dropped;
+	while (snapshots.pop(dropped))
+		;
+}
+
+std::shared_ptr<const frame> StepWorker::take(unsigned count)
+{
+	std::vector<std::shared_ptr<const frame> > taken;
+	std::shared_ptr<const frame> next;
+	for (unsigned i = 0; i < count && snapshots.pop(next); i++)
+		taken.push_back(next);
+	if (taken.size() <= 1)
+		return taken.empty() ? std::shared_ptr<const frame>() : taken[0];
+
+	// the histories of the frames passed over are joined into the newest
+	std::shared_ptr<frame> newest = std::make_shared<frame>(*taken.back());
+	newest->from = taken.front()->from;
+	newest->intersections.clear();
+	newest->finished_trapezoids.clear();
+	newest->processed.clear();
+	for (unsigned i = 0; i < taken.size(); i++)
+		append_histories(*newest, *taken[i]);
+	return newest;
+}
+
+void StepWorker::run()
+{
+	// the engine constructors do most of the work for large inputs
+	Replay replay(algorithm, blue_endpoints, red_endpoints, points);
+	if (!publish(replay, 0, false))
+		return;
+
+	bool finished = false;
+	for (unsigned step = 1; !finished; step++)
+	{
+		finished = replay.next_step();
+		if (!finished && skipping.load() && !snapshots.empty())
+		{
+			if (stopping.load())
+				return;
+			continue;
+		}
+		if (!publish(replay, step, finished))
+			return;
+	}
+	LOG(LOG_LEVEL_DEBUG, "Worker finished.");
+}
+
+// false if the worker was stopped meanwhile
+bool StepWorker::publish(const Replay & replay, unsigned step, bool finished)
+{
+	std::shared_ptr<const frame> snapshot = std::make_shared<frame>(replay.capture(step, finished, published));
+	published = snapshot->to();
+	while (!snapshots.push(snapshot))
+	{
+		if (stopping.load())
+			return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return !stopping.load();
+}
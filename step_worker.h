@@ -0,0 +1,63 @@
+#ifndef STEP_WORKER_H_
+#define STEP_WORKER_H_
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+
+#include "frame.h"
+#include "spsc_queue.h"
+
+const unsigned SNAPSHOT_QUEUE = 64;
+
+/* runs an algorithm on its own thread and publishes a frame after every step
+   through a lock-free queue; frames are immutable once published, so the GUI
+   thread can keep drawing one while the worker is already further on.
+   frames share the input and carry only the history added since the frame
+   published before them, the taker keeps the histories.
+   one thread starts, stops and takes, the worker is the only producer */
+class StepWorker
+{
+public:
+	StepWorker(unsigned capacity = SNAPSHOT_QUEUE);
+	~StepWorker() { stop(); }
+
+	// stops the previous run, copies the input once and starts the algorithm
+	void start(mode, const std::vector<double> & blue_endpoints,
+		const std::vector<double> & red_endpoints, const std::vector<double> & points);
+
+	// stops the worker and drops the frames it queued
+	void stop();
+
+	/* the worker waits while the queue is full, so every step gets shown; when
+	   fast forwarding it keeps going and publishes only when the queue is empty,
+	   the last step is always published */
+	void set_fast_forward(bool on) { skipping.store(on); }
+	bool fast_forward() const { return skipping.load(); }
+
+	/* pops at most count frames and returns the newest of them with the histories
+	   of all of them, empty if none is queued */
+	std::shared_ptr<const frame> take(unsigned count);
+
+private:
+	SpscQueue<std::shared_ptr<const frame> > snapshots;
+	std::thread worker;
+	std::atomic<bool> stopping;
+	std::atomic<bool> skipping;
+
+	// input of the current run, shared with its frames
+	mode algorithm;
+	shared_input blue_endpoints;
+	shared_input red_endpoints;
+	shared_input points;
+	history_mark published;		// history lengths of the last frame published
+
+	StepWorker(const StepWorker &);
+	StepWorker & operator = (const StepWorker &);
+
+	void run();
+	bool publish(const Replay &, unsigned step, bool finished);
+};
+
+#endif
@@ -0,0 +1,312 @@
+#include <algorithm>
+
+#include "sweep_status.h"
+
+SweepStatus::SweepStatus(status_structure kind) : kind(kind), count(0)
+{
+}
+
+size_t SweepStatus::block_of(const sort_key & key) const
+{
+	size_t b = std::upper_bound(firsts.begin(), firsts.end(), key) - firsts.begin();
+	return b == 0 ? 0 : b - 1;
+}
+
+SweepStatus::position SweepStatus::lower(const sort_key & key) const
+{
+	position p = { block_of(key), 0 };
+	if (blocks.empty())
+		return p;
+	const std::vector<slot> & block = blocks[p.block];
+	p.at = std::lower_bound(block.begin(), block.end(), key, slot_order()) - block.begin();
+	if (p.at == block.size())
+	{
+		// the next block starts above key
+		p.block++;
+		p.at = 0;
+	}
+	return p;
+}
+
+SweepStatus::position SweepStatus::upper(const sort_key & key) const
+{
+	position p = { block_of(key), 0 };
+	if (blocks.empty())
+		return p;
+	const std::vector<slot> & block = blocks[p.block];
+	p.at = std::upper_bound(block.begin(), block.end(), key, slot_order()) - block.begin();
+	if (p.at == block.size())
+	{
+		p.block++;
+		p.at = 0;
+	}
+	return p;
+}
+
+SweepStatus::position SweepStatus::find(const segment * s) const
+{
+	sort_key key(s);
+	position p = lower(key);
+	if (p.block < blocks.size() && key < blocks[p.block][p.at].key)
+		p.block = blocks.size();
+	return p;
+}
+
+SweepStatus::position SweepStatus::find_exact(const segment * s) const
+{
+	sort_key key(s);
+	position p = lower(key);
+	while (p.block < blocks.size() && at(p) != s && !(key < blocks[p.block][p.at].key))
+		p = step(p, 1);
+	if (at(p) != s)
+		p.block = blocks.size();
+	return p;
+}
+
+std::set<segment *, SweepStatus::key_order>::const_iterator SweepStatus::tree_find(const segment * s) const
+{
+	std::set<segment *, key_order>::const_iterator it = tree.lower_bound(const_cast<segment *>(s));
+	while (it != tree.end() && *it != s && !key_order()(s, *it))
+		++it;
+	return it != tree.end() && *it == s ? it : tree.end();
+}
+
+SweepStatus::position SweepStatus::step(position p, int dir) const
+{
+	position none = { blocks.size(), 0 };
+	if (p.block >= blocks.size())
+		return none;
+	if (dir > 0)
+	{
+		if (++p.at == blocks[p.block].size())
+		{
+			p.block++;
+			p.at = 0;
+		}
+		return p;
+	}
+	if (p.at > 0)
+	{
+		p.at--;
+		return p;
+	}
+	if (p.block == 0)
+		return none;
+	p.block--;
+	p.at = blocks[p.block].size() - 1;
+	return p;
+}
+
+void SweepStatus::remove(position p)
+{
+	std::vector<slot> & block = blocks[p.block];
+	block.erase(block.begin() + p.at);
+	if (block.empty())
+	{
+		blocks.erase(blocks.begin() + p.block);
+		firsts.erase(firsts.begin() + p.block);
+	}
+	else
+		firsts[p.block] = block[0].key;
+	count--;
+}
+
+void SweepStatus::insert(segment * s)
+{
+	if (kind == STATUS_TREE)
+	{
+		count += tree.insert(s).second ? 1 : 0;
+		return;
+	}
+
+	slot added = { sort_key(s), s };
+	if (blocks.empty())
+	{
+		blocks.push_back(std::vector<slot>(1, added));
+		blocks.back().reserve(BLOCK_SLOTS + 1);
+		firsts.push_back(added.key);
+		count++;
+		return;
+	}
+
+	size_t b = block_of(added.key);
+	std::vector<slot> & block = blocks[b];
+	std::vector<slot>::iterator it = std::lower_bound(block.begin(), block.end(), added.key, slot_order());
+	if (it != block.end() && !(added.key < it->key))
+		return;
+	block.insert(it, added);
+	firsts[b] = block[0].key;
+	count++;
+
+	if (block.size() > BLOCK_SLOTS)
+	{
+		// split in halves, both have room to grow again
+		std::vector<slot> high;
+		high.reserve(BLOCK_SLOTS + 1);
+		high.assign(block.begin() + block.size() / 2, block.end());
+		block.resize(block.size() / 2);
+		firsts.insert(firsts.begin() + b + 1, high[0].key);
+		blocks.insert(blocks.begin() + b + 1, std::vector<slot>());
+		blocks[b + 1].swap(high);
+	}
+}
+
+void SweepStatus::load(std::vector<segment *> & segments)
+{
+	std::stable_sort(segments.begin(), segments.end(), key_order());
+	for (size_t i = 0; i < segments.size(); i++)
+	{
+		segment * s = segments[i];
+		if (i > 0 && !key_order()(segments[i - 1], s))
+			continue;
+
+		if (kind == STATUS_TREE)
+		{
+			// the sorted segments go in at the end in constant time
+			tree.insert(tree.end(), s);
+			count++;
+			continue;
+		}
+
+		// blocks are filled halfway, like after a split
+		if (blocks.empty() || blocks.back().size() == BLOCK_SLOTS / 2)
+		{
+			blocks.push_back(std::vector<slot>());
+			blocks.back().reserve(BLOCK_SLOTS + 1);
+			firsts.push_back(sort_key(s));
+		}
+		slot added = { sort_key(s), s };
+		blocks.back().push_back(added);
+		count++;
+	}
+}
+
+void SweepStatus::erase(const segment * s)
+{
+	if (kind == STATUS_TREE)
+	{
+		std::set<segment *, key_order>::iterator it = tree.find(const_cast<segment *>(s));
+		if (it != tree.end())
+		{
+			tree.erase(it);
+			count--;
+		}
+		return;
+	}
+
+	position p = find(s);
+	if (p.block < blocks.size())
+		remove(p);
+}
+
+void SweepStatus::erase_exact(const segment * s)
+{
+	if (kind == STATUS_TREE)
+	{
+		std::set<segment *, key_order>::const_iterator it = tree_find(s);
+		if (it == tree.end())
+			it = std::find(tree.begin(), tree.end(), s);
+		if (it != tree.end())
+		{
+			tree.erase(it);
+			count--;
+		}
+		return;
+	}
+
+	position p = find_exact(s);
+	if (at(p) == s)
+	{
+		remove(p);
+		return;
+	}
+	for (p.block = 0; p.block < blocks.size(); p.block++)
+	{
+		for (p.at = 0; p.at < blocks[p.block].size(); p.at++)
+		{
+			if (blocks[p.block][p.at].s == s)
+			{
+				remove(p);
+				return;
+			}
+		}
+	}
+}
+
+void SweepStatus::retie(segment * s, double tie)
+{
+	if (kind == STATUS_TREE)
+	{
+		s->y_tie = tie;
+		return;
+	}
+
+	position p = find_exact(s);
+	s->y_tie = tie;
+	if (at(p) != s)
+		return;
+	blocks[p.block][p.at].key = sort_key(s);
+	if (p.at == 0)
+		firsts[p.block] = blocks[p.block][0].key;
+}
+
+segment * SweepStatus::above(const segment * s) const
+{
+	if (kind == STATUS_TREE)
+	{
+		std::set<segment *, key_order>::const_iterator it = tree.upper_bound(const_cast<segment *>(s));
+		return it == tree.end() ? 0 : *it;
+	}
+	return at(upper(sort_key(s)));
+}
+
+segment * SweepStatus::below(const segment * s) const
+{
+	if (kind == STATUS_TREE)
+	{
+		// nothing below the first element, decrementing begin() is undefined
+		std::set<segment *, key_order>::const_iterator it = tree.lower_bound(const_cast<segment *>(s));
+		return it == tree.begin() ? 0 : *--it;
+	}
+
+	position p = lower(sort_key(s));
+	if (p.block == blocks.size())
+	{
+		if (blocks.empty())
+			return 0;
+		p.block--;
+		p.at = blocks[p.block].size();
+	}
+	if (p.at == 0 && p.block == 0)
+		return 0;
+	if (p.at == 0)
+	{
+		p.block--;
+		p.at = blocks[p.block].size();
+	}
+	return blocks[p.block][p.at - 1].s;
+}
+
+segment * SweepStatus::successor(const segment * s) const
+{
+	if (kind == STATUS_TREE)
+	{
+		std::set<segment *, key_order>::const_iterator it = tree_find(s);
+		if (it == tree.end() || ++it == tree.end())
+			return 0;
+		return *it;
+	}
+	return at(step(find_exact(s), 1));
+}
+
+segment * SweepStatus::predecessor(const segment * s) const
+{
+	if (kind == STATUS_TREE)
+	{
+		std::set<segment *, key_order>::const_iterator it = tree_find(s);
+		if (it == tree.end() || it == tree.begin())
+			return 0;
+		return *--it;
+	}
+	return at(step(find_exact(s), -1));
+}
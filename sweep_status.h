@@ -0,0 +1,145 @@
+#ifndef SWEEP_STATUS_H_
+#define SWEEP_STATUS_H_
+
+#include <set>
+#include <vector>
+
+#include "segment.h"
+
+enum status_structure
+{
+	STATUS_TREE,	// std::set of segment pointers, a red-black tree
+	STATUS_BLOCKS	// sorted array split into blocks, keys cached next to the pointers
+};
+
+/* segments crossing the sweep line ordered by y_sweep and then by y_tie, which
+   orders segments through the same point of the sweep line; keys are unique like
+   in a std::set: a segment with the key of a listed one is not inserted and lookups
+   by key find the listed one.
+   STATUS_BLOCKS keeps key, pointer slots in blocks of at most BLOCK_SLOTS, so a
+   search compares doubles in contiguous memory instead of following a pointer per
+   level and another one per comparison, a neighbor is the next slot and the
+   update of every key at each event is a linear pass */
+class SweepStatus
+{
+public:
+	SweepStatus(status_structure = STATUS_TREE);
+
+	status_structure structure() const { return kind; }
+	bool empty() const { return count == 0; }
+	size_t size() const { return count; }
+
+	void insert(segment *);
+
+	/* lists the segments in an empty status at once, sorting them by key first;
+	   of the ones with the same key only the first is listed, like with insert() */
+	void load(std::vector<segment *> &);
+
+	// removes the segment with the key of s
+	void erase(const segment *);
+
+	// removes s itself, looking at every segment if its key does not lead to it
+	void erase_exact(const segment *);
+
+	// first segment above / last segment below the key of s, 0 if there is none
+	segment * above(const segment *) const;
+	segment * below(const segment *) const;
+
+	/* neighbor above / below s itself, 0 if none or s is not listed; segments that
+	   came to share a key are told apart, so walking the neighbors does not stall */
+	segment * successor(const segment *) const;
+	segment * predecessor(const segment *) const;
+
+	// set_keys(segment &) sets y_sweep and y_tie of every segment, the order must stay the same
+	template <class Keys> void update(Keys set_keys);
+
+	// sets y_tie of the listed s, its place in the order must stay the same
+	void retie(segment * s, double tie);
+
+private:
+	static const unsigned BLOCK_SLOTS = 64;
+
+	struct key_order
+	{
+		bool operator () (const segment * s1, const segment * s2) const
+		{
+			return s1->y_sweep < s2->y_sweep || (s1->y_sweep == s2->y_sweep && s1->y_tie < s2->y_tie);
+		}
+	};
+
+	struct sort_key
+	{
+		double y, tie;
+
+		sort_key() {}
+		sort_key(const segment * s) : y(s->y_sweep), tie(s->y_tie) {}
+		bool operator < (const sort_key & k) const { return y < k.y || (y == k.y && tie < k.tie); }
+	};
+
+	struct slot
+	{
+		sort_key key;
+		segment * s;
+	};
+
+	// binary searches in a block by key
+	struct slot_order
+	{
+		bool operator () (const slot & a, const sort_key & k) const { return a.key < k; }
+		bool operator () (const sort_key & k, const slot & a) const { return k < a.key; }
+	};
+
+	// block, slot; block == blocks.size() past the end
+	struct position
+	{
+		size_t block;
+		size_t at;
+	};
+
+	status_structure kind;
+	size_t count;
+	std::set<segment *, key_order> tree;
+	std::vector<std::vector<slot> > blocks;	// none of them empty
+	std::vector<sort_key> firsts;		// key of the first slot of each block
+
+	// last block starting at or below key, 0 if key is below all of them
+	size_t block_of(const sort_key &) const;
+
+	// first slot with a key not below (lower) or above (upper) key
+	position lower(const sort_key &) const;
+	position upper(const sort_key &) const;
+
+	// the slot with the key of s, past the end if there is none
+	position find(const segment *) const;
+
+	// the slot or tree node of s itself among the ones with its key, past the end if it is not listed
+	position find_exact(const segment *) const;
+	std::set<segment *, key_order>::const_iterator tree_find(const segment *) const;
+
+	segment * at(position p) const { return p.block < blocks.size() ? blocks[p.block][p.at].s : 0; }
+	position step(position, int dir) const;
+	void remove(position);
+};
+
+template <class Keys> void SweepStatus::update(Keys set_keys)
+{
+	if (kind == STATUS_TREE)
+	{
+		for (std::set<segment *, key_order>::iterator it = tree.begin(); it != tree.end(); ++it)
+			set_keys(**it);
+		return;
+	}
+
+	for (size_t b = 0; b < blocks.size(); b++)
+	{
+		std::vector<slot> & block = blocks[b];
+		for (size_t i = 0; i < block.size(); i++)
+		{
+			set_keys(*block[i].s);
+			block[i].key = sort_key(block[i].s);
+		}
+		firsts[b] = block[0].key;
+	}
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include "thread_pool.h"
+
+namespace
+{
+	// pool and queue of the current worker thread
+	thread_local const ThreadPool* current_pool = 0;
+	thread_local unsigned current_queue = 0;
+}
+
+ThreadPool::ThreadPool(unsigned threads) : queued(0), stopping(false)
+{
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	if (threads == 0)
+		threads = 1;
+
+	for (unsigned i = 0; i < threads; i++)
+		queues.push_back(new task_queue);
+
+	for (unsigned i = 0; i + 1 < threads; i++)
+		workers.push_back(std::thread(&ThreadPool::worker_loop, this, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(sleep_lock);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (unsigned i = 0; i < workers.size(); i++)
+		workers[i].join();
+	for (unsigned i = 0; i < queues.size(); i++)
+		delete queues[i];
+}
+
+void ThreadPool::run(TaskGroup& group, const std::function<void()>& f)
+{
+	task t;
+	t.f = f;
+	t.group = &group;
+	++group.pending;
+
+	{
+		std::lock_guard<std::mutex> guard(sleep_lock);
+		++queued;
+	}
+
+	task_queue* q = queues[queue_index()];
+	{
+		std::lock_guard<std::mutex> guard(q->lock);
+		q->tasks.push_back(t);
+	}
+	wake.notify_one();
+}
+
+void ThreadPool::wait(TaskGroup& group)
+{
+	unsigned index = queue_index();
+	task t;
+	while (!group.done())
+	{
+		if (pop(index, t) || steal(index, t))
+			execute(t);
+		else
+			std::this_thread::yield();
+	}
+}
+
+unsigned ThreadPool::parallel_for(unsigned n, const std::function<void(unsigned, unsigned, unsigned)>& f)
+{
+	unsigned slices = size() < n ? size() : n;
+	if (slices <= 1)
+	{
+		f(0, 0, n);
+		return 1;
+	}
+
+	TaskGroup group;
+	for (unsigned i = 1; i < slices; i++)
+	{
+		unsigned begin = (unsigned)((unsigned long long)n * i / slices);
+		unsigned end = (unsigned)((unsigned long long)n * (i+1) / slices);
+		run(group, [&f, i, begin, end]() { f(i, begin, end); });
+	}
+	f(0, 0, (unsigned)((unsigned long long)n / slices));
+	wait(group);
+	return slices;
+}
+
+void ThreadPool::worker_loop(unsigned index)
+{
+	current_pool = this;
+	current_queue = index;
+
+	task t;
+	for (;;)
+	{
+		if (pop(index, t) || steal(index, t))
+		{
+			execute(t);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> guard(sleep_lock);
+		wake.wait(guard, [this]() { return stopping || queued > 0; });
+		if (stopping)
+			return;
+	}
+}
+
+// worker threads use their own queue, everyone else shares the last one
+unsigned ThreadPool::queue_index() const
+{
+	return current_pool == this ? current_queue : (unsigned)queues.size() - 1;
+}
+
+bool ThreadPool::pop(unsigned index, task& t)
+{
+	task_queue* q = queues[index];
+	std::lock_guard<std::mutex> guard(q->lock);
+	if (q->tasks.empty())
+		return false;
+
+	t = q->tasks.back();
+	q->tasks.pop_back();
+	--queued;
+	return true;
+}
+
+bool ThreadPool::steal(unsigned index, task& t)
+{
+	for (unsigned i = 1; i < queues.size(); i++)
+	{
+		task_queue* q = queues[(index + i) % queues.size()];
+		std::lock_guard<std::mutex> guard(q->lock);
+		if (q->tasks.empty())
+			continue;
+
+		t = q->tasks.front();
+		q->tasks.pop_front();
+		--queued;
+		return true;
+	}
+	return false;
+}
+
+void ThreadPool::execute(task& t)
+{
+	t.f();
+	--t.group->pending;
+}
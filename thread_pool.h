@@ -0,0 +1,74 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+// number of unfinished tasks spawned into the pool
+class TaskGroup
+{
+public:
+	TaskGroup() : pending(0) {}
+	bool done() const { return pending.load() == 0; }
+
+private:
+	std::atomic<unsigned> pending;
+	friend class ThreadPool;
+};
+
+/* work-stealing pool: every worker owns a deque, takes its own tasks
+   from the back and steals from the front of the other deques */
+class ThreadPool
+{
+public:
+	// 0 = one thread per core, the calling thread counts as one of them
+	ThreadPool(unsigned threads = 0);
+	~ThreadPool();
+
+	unsigned size() const { return (unsigned)workers.size() + 1; }
+
+	void run(TaskGroup&, const std::function<void()>&);
+
+	// helps with queued tasks until all tasks of the group are finished
+	void wait(TaskGroup&);
+
+	/* calls f(slice, begin, end) on at most size() slices of [0, n) in parallel,
+	   returns the number of slices */
+	unsigned parallel_for(unsigned n, const std::function<void(unsigned, unsigned, unsigned)>&);
+
+private:
+	struct task
+	{
+		std::function<void()> f;
+		TaskGroup* group;
+	};
+
+	struct task_queue
+	{
+		std::mutex lock;
+		std::deque<task> tasks;
+	};
+
+	std::vector<std::thread> workers;
+	std::vector<task_queue*> queues;	// one per worker, the last one is for outside threads
+	std::atomic<unsigned> queued;
+	std::atomic<bool> stopping;
+	std::mutex sleep_lock;
+	std::condition_variable wake;
+
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator = (const ThreadPool&);
+
+	void worker_loop(unsigned);
+	unsigned queue_index() const;
+	bool pop(unsigned, task&);
+	bool steal(unsigned, task&);
+	void execute(task&);
+};
+
+#endif
@@ -1,18 +1,225 @@
-#include <stdexcept>
+#include <cmath>
+#include <limits>
+
 #include "trapezoid_sweep.h"
+#include "bulk_input.h"
+#include "log.h"
+
+namespace
+{
+	/* a windowed sweep clips to its window grown by this much of its size on each
+	   side: two segments cut at the same point of an edge would put their crossing
+	   there only up to rounding, and one that ends there would leave the sweep
+	   before it is found; report() keeps the window half open */
+	const double WINDOW_MARGIN = 1e-6;
+
+	// x,y where the line through a and b crosses the line through c and d
+	inline void line_crossing(double ax, double ay, double bx, double by,
+		double cx, double cy, double dx, double dy, double & x, double & y)
+	{
+		double rx = bx - ax, ry = by - ay;
+		double sx = dx - cx, sy = dy - cy;
+		double t = ((cx - ax) * sy - (cy - ay) * sx) / (rx * sy - ry * sx);
+		x = ax + t * rx;
+		y = ay + t * ry;
+	}
+
+	/* Liang-Barsky: cuts segment x1,y1,x2,y2 down to the part inside box
+	   x0,y0,x1,y1 in place, false if less than a segment is left; an end that was
+	   cut lies exactly on the edge that cut it */
+	bool clip(double * v, const double * box)
+	{
+		double dx = v[2] - v[0], dy = v[3] - v[1];
+		double p[] = { -dx, dx, -dy, dy };
+		double q[] = { v[0] - box[0], box[2] - v[0], v[1] - box[1], box[3] - v[1] };
+		const unsigned axis[] = { 0, 0, 1, 1 };
+		const unsigned edge[] = { 0, 2, 1, 3 };
+
+		double t0 = 0.0, t1 = 1.0;
+		int enter = -1, leave = -1;
+		for (int k = 0; k < 4; k++)
+		{
+			if (p[k] == 0)
+			{
+				if (q[k] < 0)
+					return false;
+				continue;
+			}
+			double t = q[k] / p[k];
+			if (p[k] < 0 && t > t0)
+			{
+				t0 = t;
+				enter = k;
+			}
+			else if (p[k] > 0 && t < t1)
+			{
+				t1 = t;
+				leave = k;
+			}
+		}
+		if (t0 >= t1)
+			return false;
+
+		double c[] = { v[0] + t0 * dx, v[1] + t0 * dy, v[0] + t1 * dx, v[1] + t1 * dy };
+		if (enter >= 0)
+			c[axis[enter]] = box[edge[enter]];
+		if (leave >= 0)
+			c[2 + axis[leave]] = box[edge[leave]];
+		for (unsigned k = 0; k < 4; k++)
+			v[k] = c[k];
+		return true;
+	}
+
+	// y_tie of a segment on the sweep line, see update_y_sweep()
+	inline double slope_tie(const segment & s, bool ending)
+	{
+		double slope = (s.right.y - s.left.y) / (s.right.x - s.left.x);
+		return ending ? -slope : slope;
+	}
+
+	// y of blue segment id at x, vertical ones nudged like in init_queue(), an unbounded side is bottom or top
+	inline double side_y(const std::vector<double> & blue, unsigned id, bool upper, double x,
+		double bottom, double top)
+	{
+		if (id == TrapezoidSweep::NONE)
+			return upper ? top : bottom;
+
+		const double * v = &blue[4 * (size_t)id];
+		double x1 = v[0];
+		if (v[2] == x1)
+			x1 += 0.0000001;
+		double y = v[1] + (v[3] - v[1]) / (v[2] - x1) * (x - x1);
+		return y < bottom ? bottom : (y > top ? top : y);
+	}
+}
 
-TrapezoidSweep::TrapezoidSweep(const std::vector<double>& blue_endpoints, const std::vector<double>& red_endpoints)
+TrapezoidSweep::TrapezoidSweep(const std::vector<double>& blue_endpoints, const std::vector<double>& red_endpoints,
+	status_structure status)
 {
+	BulkInput blue(blue_endpoints, 4);
+	BulkInput red(red_endpoints, 4);
+	init(blue, red, false, 0, status);
+}
+
+TrapezoidSweep::TrapezoidSweep(const std::vector<double>& blue_endpoints, const std::vector<double>& red_endpoints,
+	double x0, double y0, double x1, double y1, status_structure status)
+{
+	BulkInput blue(blue_endpoints, 4);
+	BulkInput red(red_endpoints, 4);
+	double box[] = { x0, y0, x1, y1 };
+	init(blue, red, false, box, status);
+}
+
+TrapezoidSweep::TrapezoidSweep(const std::vector<std::vector<double> >& blue_polylines,
+	const std::vector<std::vector<double> >& red_polylines, status_structure status)
+{
+	std::vector<double> none;
+	BulkInput empty(none, 4);
+	init(empty, empty, false, 0, status);
+	init_chains(blue_polylines, BLUE);
+	init_chains(red_polylines, RED);
+}
+
+TrapezoidSweep::~TrapezoidSweep()
+{
+	std::multimap<endpoint,segment*,event_order>::iterator it;
+	for (it = queue.begin(); it != queue.end(); ++it)
+	{
+		if (it->first.type == LEFT)
+			delete it->second;
+	}
+}
+
+void TrapezoidSweep::init(const BulkInput & blue, const BulkInput & red, bool detect, const double * clip_window,
+	status_structure status)
+{
+	L_red = SweepStatus(status);
+	L_blue = SweepStatus(status);
 	x_sweep = 0.0;
+	x_keys = -infinity;
 	y_min =  infinity;
 	y_max = -infinity;
+	input_flags = INPUT_OK;
+	detect_only = detect;
+	keep_trapezoids = !detect;
+	windowed = clip_window != 0;
+	for (unsigned k = 0; k < 4; k++)
+		window[k] = windowed ? clip_window[k] : (k < 2 ? -infinity : infinity);
+	for (unsigned k = 0; k < 4; k++)
+	{
+		double margin = WINDOW_MARGIN * (window[k % 2 + 2] - window[k % 2]);
+		clip_box[k] = windowed ? (k < 2 ? window[k] - margin : window[k] + margin) : window[k];
+	}
 	NULL_POINT = endpoint(infinity, infinity);
 	NULL_SEGMENT = segment(NULL_POINT, NULL_POINT, RED);
 
-	// initialize queue..
-	init_queue(blue_endpoints, BLUE);
-	init_queue(red_endpoints, RED);
+	// initialize queue, a segment can only meet the other color inside its bounding box
+	double blue_box[] = { blue.min_x(), blue.min_y(), blue.max_x(), blue.max_y() };
+	double red_box[] = { red.min_x(), red.min_y(), red.max_x(), red.max_y() };
+	init_queue(blue, BLUE, detect ? red_box : 0);
+	init_queue(red, RED, detect ? blue_box : 0);
 	current_endpoint = NULL_POINT;
+
+	if (windowed)
+	{
+		y_min = y_min > clip_box[1] ? y_min : clip_box[1];
+		y_max = y_max < clip_box[3] ? y_max : clip_box[3];
+		list_left_edge();
+	}
+}
+
+bool TrapezoidSweep::find_intersection(const std::vector<double>& blue_endpoints,
+	const std::vector<double>& red_endpoints, unsigned & red_id, unsigned & blue_id)
+{
+	BulkInput blue(blue_endpoints, 4);
+	BulkInput red(red_endpoints, 4);
+	if (blue.size() == 0 || red.size() == 0)
+		return false;
+	if (blue.max_x() < red.min_x() || red.max_x() < blue.min_x() ||
+		blue.max_y() < red.min_y() || red.max_y() < blue.min_y())
+		return false;
+
+	TrapezoidSweep detector;
+	detector.init(blue, red, true, 0);
+	detector.sweep();
+	if (detector.pairs.empty())
+		return false;
+
+	red_id = detector.pairs[0];
+	blue_id = detector.pairs[1];
+	return true;
+}
+
+std::vector<double> TrapezoidSweep::tiled_intersections(const std::vector<double>& blue_endpoints,
+	const std::vector<double>& red_endpoints, double x0, double y0, double x1, double y1,
+	unsigned columns, unsigned rows, ThreadPool & pool)
+{
+	std::vector<std::vector<double> > tiles(columns * rows);
+	TaskGroup group;
+	for (unsigned row = 0; row < rows; row++)
+	{
+		for (unsigned column = 0; column < columns; column++)
+		{
+			// neighbors compute their shared edge the same way
+			double tx0 = x0 + (x1 - x0) * column / columns;
+			double tx1 = column + 1 == columns ? x1 : x0 + (x1 - x0) * (column + 1) / columns;
+			double ty0 = y0 + (y1 - y0) * row / rows;
+			double ty1 = row + 1 == rows ? y1 : y0 + (y1 - y0) * (row + 1) / rows;
+			std::vector<double> & out = tiles[row * columns + column];
+			pool.run(group, [&blue_endpoints, &red_endpoints, &out, tx0, ty0, tx1, ty1]()
+			{
+				TrapezoidSweep tile(blue_endpoints, red_endpoints, tx0, ty0, tx1, ty1);
+				tile.sweep();
+				out = tile.intersections();
+			});
+		}
+	}
+	pool.wait(group);
+
+	std::vector<double> all;
+	for (unsigned i = 0; i < tiles.size(); i++)
+		all.insert(all.end(), tiles[i].begin(), tiles[i].end());
+	return all;
 }
 
 bool TrapezoidSweep::next_step()
@@ -21,6 +228,13 @@ bool TrapezoidSweep::next_step()
 	{
 		done = false;
 		queue_it = queue.begin();
+		if (windowed)
+		{
+			// past the events on the left edge, list_left_edge() did them
+			endpoint edge_end(clip_box[0], infinity);
+			edge_end.type = RIGHT;
+			queue_it = queue.lower_bound(edge_end);
+		}
 	}
 
 	if (queue_it == queue.end())
@@ -29,30 +243,49 @@ bool TrapezoidSweep::next_step()
 		return done;
 	}
 
-	endpoint p = queue_it->first;
-	segment* s = queue_it->second;
+	process_event(queue_it->first, queue_it->second);
 
+	++queue_it;
+	if (detect_only && !pairs.empty())
+		done = true;
+	return done;
+}
+
+/* sweeps over endpoint p of segment s, the events come from the queue or from an ExternalSweep;
+   at an inner vertex of a chain the edge ending there is swept like a segment ending there,
+   then the next one like a segment starting there */
+void TrapezoidSweep::process_event(const endpoint & p, segment * s)
+{
 	current_segment = *s;
 	current_endpoint = p;
 
 	x_sweep = p.x;
 
-	// update y-coordinate of intersection with sweep line
+	/* update y-coordinate of intersection with sweep line; the keys depend on x_sweep
+	   alone, every segment that came in or moved on since got its own */
 	s->y_sweep = p.y;
-	update_y_sweep(L_red);
-	update_y_sweep(L_blue);
-	
-	finished_t.insert(finished_t.end(),current_t.begin(),current_t.end());
-	current_t.clear();
-
-	if (s->color == RED || p.type == LEFT)
+	s->y_tie = slope_tie(*s, p.type != LEFT);
+	if (x_sweep != x_keys)
 	{
-		add_trapezoid(*search(L_blue,s, 1),*search(L_blue,s,-1));
+		update_y_sweep(L_red);
+		update_y_sweep(L_blue);
+		x_keys = x_sweep;
 	}
-	else
+	
+	if (keep_trapezoids)
 	{
-		add_trapezoid(*search(L_blue,s, 1),*s);
-		add_trapezoid(*s,*search(L_blue,s,-1));
+		finished_t.insert(finished_t.end(),current_t.begin(),current_t.end());
+		current_t.clear();
+
+		if (s->color == RED || p.type == LEFT)
+		{
+			add_trapezoid(search(L_blue,s, 1),search(L_blue,s,-1));
+		}
+		else
+		{
+			add_trapezoid(search(L_blue,s, 1),s);
+			add_trapezoid(s,search(L_blue,s,-1));
+		}
 	}
 			
 	// find the nearest s_blue in both directions
@@ -77,15 +310,16 @@ bool TrapezoidSweep::next_step()
 			insert_segment(L_red , s);
 		if (s->color == BLUE)
 			insert_segment(L_blue, s);
-	} else {
+	} else if (p.type == RIGHT) {
 		if (s->color == RED)
 			delete_segment(L_red , s);
 		if (s->color == BLUE)
 			delete_segment(L_blue, s);
+	} else {
+		next_edge(s->color == RED ? L_red : L_blue, s);
+		advance(search(L_blue,s, 1));
+		advance(search(L_blue,s,-1));
 	}
-	
-	++queue_it;
-	return done;
 }
 
 double TrapezoidSweep::current_endpoint_x() const
@@ -99,55 +333,37 @@ double TrapezoidSweep::current_endpoint_y() const
 }
 
 
-void TrapezoidSweep::insert_segment(std::set<segment*,set_comp>& segment_list, segment* s)
+void TrapezoidSweep::insert_segment(SweepStatus& segment_list, segment* s)
 {
 	segment_list.insert(s);
 }
 
-void TrapezoidSweep::delete_segment(std::set<segment*,set_comp>& segment_list, segment* s)
+void TrapezoidSweep::delete_segment(SweepStatus& segment_list, segment* s)
 {
-	std::set<segment*,set_comp>::iterator it = segment_list.find(s);
-	if (it != segment_list.end())
-		segment_list.erase(it);
+	// a neighbor with the same key must not go instead
+	segment_list.erase_exact(s);
 }
 
 // returns the element in list L that is just grater (or less) that s if dir = +1/-1
-segment* TrapezoidSweep::search(std::set<segment*,set_comp>& segment_set, segment* s, int dir)
+segment* TrapezoidSweep::search(SweepStatus& segment_set, segment* s, int dir)
 {
-	std::set<segment*,set_comp>::const_iterator it;
-
-	if (dir == 0 || segment_set.empty())
-		return &NULL_SEGMENT;
+	segment* found = 0;
+	if (dir > 0)
+		found = segment_set.above(s);
 	else if (dir < 0)
-		it = --segment_set.lower_bound(s);
-	else
-		it = segment_set.upper_bound(s);
-
-	if (it == segment_set.end())
-		return &NULL_SEGMENT;
-	else
-		return *it;
+		found = segment_set.below(s);
+	return found ? found : &NULL_SEGMENT;
 }
 
 // returns the successor / predecessor of s in list L if dir = +1/-1
-segment* TrapezoidSweep::next(std::set<segment*,set_comp>& segment_set, segment* s, int dir)
+segment* TrapezoidSweep::next(SweepStatus& segment_set, segment* s, int dir)
 {
-	std::set<segment*,set_comp>::const_iterator it = segment_set.find(s);//!
-
-	if (segment_set.empty() || it == segment_set.end())
-		return &NULL_SEGMENT;
-
-	if (dir < 0)
-		--it;
-	else if (dir > 0)
-		++it;
-	else
-		return &NULL_SEGMENT;
-
-	if (it != segment_set.end())
-		return *it;
-	else
-		return &NULL_SEGMENT;
+	segment* found = 0;
+	if (dir > 0)
+		found = segment_set.successor(s);
+	else if (dir < 0)
+		found = segment_set.predecessor(s);
+	return found ? found : &NULL_SEGMENT;
 }
 
 double TrapezoidSweep::intersection(segment s, double x) const
@@ -221,26 +437,101 @@ double TrapezoidSweep::meet(segment s_red, segment s_blue) const
 }
 	
 
+/* advance() only gets here for segments that meet, the point is left for later
+   unless the window has to be checked */
 void TrapezoidSweep::report(const segment* s_red, const segment* s_blue)
 {
-	endpoint p = intersection(*s_red, *s_blue);
+	if (windowed)
+	{
+		const double * r = &red_coordinates[4 * (size_t)s_red->id];
+		const double * b = &blue_coordinates[4 * (size_t)s_blue->id];
+		double x, y;
+		line_crossing(r[0], r[1], r[2], r[3], b[0], b[1], b[2], b[3], x, y);
+		if (x < window[0] || x >= window[2] || y < window[1] || y >= window[3])
+			return;
+	}
+
+	pairs.push_back(s_red->id);
+	pairs.push_back(s_blue->id);
+}
 
-	if (p != NULL_POINT)
+const std::vector<double> & TrapezoidSweep::intersections() const
+{
+	if (m_intersections.size() < pairs.size())
 	{
-		m_intersections.push_back(p.x);
-		m_intersections.push_back(p.y);
+		std::vector<unsigned> fresh(pairs.begin() + m_intersections.size(), pairs.end());
+		std::vector<double> points = intersection_points(fresh);
+		m_intersections.insert(m_intersections.end(), points.begin(), points.end());
 	}
+	return m_intersections;
 }
 
-void TrapezoidSweep::update_y_sweep(std::set<segment*,set_comp> & segment_set)
+/* the segments of a block are gathered into separate arrays first, so the
+   arithmetic runs over contiguous doubles without branches and vectorizes */
+std::vector<double> TrapezoidSweep::intersection_points(const std::vector<unsigned> & requested) const
 {
-	segment *s;
-	std::set<segment*,set_comp>::iterator it;
-	for (it = segment_set.begin(); it != segment_set.end(); ++it)
+	const unsigned BLOCK = 64;
+	double ax[BLOCK], ay[BLOCK], bx[BLOCK], by[BLOCK];
+	double cx[BLOCK], cy[BLOCK], dx[BLOCK], dy[BLOCK];
+	double x[BLOCK], y[BLOCK];
+
+	// stands in for a segment that is not there, the point comes out NaN
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	const double missing[] = { nan, nan, nan, nan };
+	size_t red_count = red_coordinates.size() / 4, blue_count = blue_coordinates.size() / 4;
+	unsigned bad = 0;
+
+	std::vector<double> out(requested.size() - requested.size() % 2);
+	unsigned count = (unsigned)(requested.size() / 2);
+	for (unsigned begin = 0; begin < count; begin += BLOCK)
 	{
-		s = *it;
-		s->y_sweep = (s->left.x != s->right.x) ? intersection(*s,x_sweep) : s->right.y;
+		unsigned n = count - begin < BLOCK ? count - begin : BLOCK;
+		for (unsigned i = 0; i < n; i++)
+		{
+			unsigned red = requested[2 * (begin + i)], blue = requested[2 * (begin + i) + 1];
+			const double * r = missing;
+			const double * b = missing;
+			if (red < red_count && blue < blue_count)
+			{
+				r = &red_coordinates[4 * (size_t)red];
+				b = &blue_coordinates[4 * (size_t)blue];
+			}
+			else
+				bad++;
+			ax[i] = r[0]; ay[i] = r[1]; bx[i] = r[2]; by[i] = r[3];
+			cx[i] = b[0]; cy[i] = b[1]; dx[i] = b[2]; dy[i] = b[3];
+		}
+
+		for (unsigned i = 0; i < n; i++)
+			line_crossing(ax[i], ay[i], bx[i], by[i], cx[i], cy[i], dx[i], dy[i], x[i], y[i]);
+
+		for (unsigned i = 0; i < n; i++)
+		{
+			out[2 * (begin + i)] = x[i];
+			out[2 * (begin + i) + 1] = y[i];
+		}
 	}
+	if (bad > 0)
+		LOG(LOG_LEVEL_WARNING, "Gave NaN points for " << bad << " pairs with ids of no segment.");
+	return out;
+}
+
+/* segments through the same point of the sweep line are ordered by their slope
+   on the side they continue to: the ones ending here by the slope to the left,
+   where the steeper one is lower, the others by the slope to the right */
+void TrapezoidSweep::update_y_sweep(SweepStatus & segment_set)
+{
+	segment_set.update([this](segment & s)
+	{
+		// at an end on the sweep line y is exact, the line through a steep segment could miss its own endpoint
+		if (s.right.x <= x_sweep)
+			s.y_sweep = s.right.y;
+		else if (s.left.x >= x_sweep)
+			s.y_sweep = s.left.y;
+		else
+			s.y_sweep = intersection(s,x_sweep);
+		s.y_tie = slope_tie(s, s.right.x <= x_sweep);
+	});
 }
 
 /* for each s*_red that intersects s*, reports the intersection of s*_red with s*
@@ -266,6 +557,8 @@ void TrapezoidSweep::advance(segment* s)
 				(s_blue != &NULL_SEGMENT);)
 			{
 				report(s_red, s_blue);
+				if (detect_only)
+					return;
 				s_blue = next(L_blue, s_blue, -dir);
 			}
 			s_red->x0 = x0_red = meet(*s_red, *s);
@@ -275,138 +568,285 @@ void TrapezoidSweep::advance(segment* s)
 	}
 }
 
-void TrapezoidSweep::init_queue(const std::vector<double> & endpoints, segment_color color)
+void TrapezoidSweep::init_queue(const BulkInput & input, segment_color color, const double * box)
+{
+	input_flags |= input.errors();
+
+	// ids follow the input, skipped records keep their place
+	std::vector<double> & coordinates = color == RED ? red_coordinates : blue_coordinates;
+	coordinates.assign(4 * (size_t)input.input_size(), 0.0);
+
+	for (unsigned i = 0; i < input.size(); i++)
+	{
+		const double * v = input.data() + 4 * (size_t)i;
+		if (box && ((v[0] < box[0] && v[2] < box[0]) || (v[0] > box[2] && v[2] > box[2]) ||
+			(v[1] < box[1] && v[3] < box[1]) || (v[1] > box[3] && v[3] > box[3])))
+			continue;
+
+		// points are computed from the input, the clipped part lies on the same line
+		unsigned id = input.origin(i);
+		double * given = &coordinates[4 * (size_t)id];
+		for (unsigned k = 0; k < 4; k++)
+			given[k] = v[k];
+
+		double c[] = { v[0], v[1], v[2], v[3] };
+		if (windowed && !clip(c, clip_box))
+			continue;
+		add_segment(c, id, color);
+	}
+
+	if (input.min_y() < y_min)
+		y_min = input.min_y();
+	if (input.max_y() > y_max)
+		y_max = input.max_y();
+}
+
+/* nothing starts left of clip_box, so every event on its left edge starts a
+   segment there and finds no intersection left of the sweep line; one by one they
+   would cost a pass over the lists each, for the many segments crossing the edge
+   they are sorted and listed at once; only the zero width trapezoids of those
+   events are left out */
+void TrapezoidSweep::list_left_edge()
+{
+	x_sweep = clip_box[0];
+	std::vector<segment *> red, blue;
+	std::multimap<endpoint,segment*,event_order>::iterator it;
+	for (it = queue.begin(); it != queue.end() && it->first.x <= clip_box[0]; ++it)
+	{
+		segment * s = it->second;
+		s->y_sweep = s->left.y;
+		s->y_tie = slope_tie(*s, false);
+		if (s->color == RED)
+			red.push_back(s);
+		else
+			blue.push_back(s);
+	}
+	L_red.load(red);
+	L_blue.load(blue);
+	x_keys = x_sweep;
+}
+
+void TrapezoidSweep::add_segment(const double * c, unsigned id, segment_color color)
 {
 	endpoint left_point;
 	endpoint right_point;
 
-	for (unsigned i = 0; i < endpoints.size();)
+	left_point.x  = c[0];
+	left_point.y  = c[1];
+	right_point.x = c[2];
+	right_point.y = c[3];
+
+	if (right_point.x == left_point.x)
 	{
-		try
-		{
-			left_point.x  = endpoints.at(i++);
-			left_point.y  = endpoints.at(i++);
-			right_point.x = endpoints.at(i++);
-			right_point.y = endpoints.at(i++);
-		}
-		catch (std::out_of_range)
-		{
-			break;
-		}
+		left_point.x += 0.0000001;
+	}
 
-		if (right_point.x == left_point.x)
-		{
-			left_point.x += 0.0000001;
-		}
+	right_point.type = RIGHT;
+	left_point.type = LEFT;
 
-		right_point.type = RIGHT;
-		left_point.type = LEFT;
+	segment * s;
+	if (left_point > right_point)
+	{
+		right_point.type = LEFT;
+		left_point.type = RIGHT;
+		s = new segment(right_point, left_point, color);
+	}
+	else
+	{
+		s = new segment(left_point, right_point, color);
+	}
+	queue.insert(std::make_pair(left_point, s));
+	queue.insert(std::make_pair(right_point, s));
 
-		if (left_point > right_point)
-		{
-			right_point.type = LEFT;
-			left_point.type = RIGHT;
-			queue[right_point] = queue[left_point] = new segment(right_point, left_point, color);
-		}
-		else
-		{
-			queue[left_point] = queue[right_point] = new segment(left_point, right_point, color);
-		}
+	s->id = id;
+}
 
-		//update max and min
-		if (right_point.y > y_max)
-			y_max = right_point.y;
-		if (left_point.y > y_max)
-			y_max = left_point.y;
-		if (right_point.y < y_min)
-			y_min = right_point.y;
-		if (left_point.y < y_min)
-			y_min = left_point.y;
+std::vector<double> TrapezoidSweep::polyline_edges(const std::vector<std::vector<double> > & polylines)
+{
+	std::vector<double> edges;
+	for (size_t p = 0; p < polylines.size(); p++)
+	{
+		const std::vector<double> & line = polylines[p];
+		for (size_t k = 2; k + 1 < line.size(); k += 2)
+			edges.insert(edges.end(), line.begin() + k - 2, line.begin() + k + 2);
 	}
+	return edges;
 }
 
-void TrapezoidSweep::add_trapezoid(segment s_upper, segment s_lower)
+void TrapezoidSweep::init_chains(const std::vector<std::vector<double> > & polylines, segment_color color)
 {
-	endpoint top_left;
-	endpoint top_right;
-	endpoint bottom_left;
-	endpoint bottom_right;
+	std::vector<double> & coordinates = color == RED ? red_coordinates : blue_coordinates;
+	coordinates = polyline_edges(polylines);
+	BulkInput input(coordinates, 4);
+	input_flags |= input.errors();
 
-	top_right.x = x_sweep;
-	bottom_right.x = x_sweep;
-
-	if (s_upper != NULL_SEGMENT && s_lower != NULL_SEGMENT)
+	unsigned id = 0;			// first edge of the polyline
+	for (size_t p = 0; p < polylines.size(); p++)
 	{
-		top_right.y = s_upper.y_sweep;
-		bottom_right.y = s_lower.y_sweep;
-
-		if (s_upper.left > s_lower.left)
+		const std::vector<double> & line = polylines[p];
+		if (line.size() % 2 != 0)
+			input_flags |= INPUT_TRAILING;
+		unsigned edges = line.size() < 4 ? 0 : (unsigned)(line.size() / 2 - 1);
+
+		// a chain ends where x turns back, at a vertical edge and at an edge that is not finite
+		unsigned first = 0;
+		int dir = 0;
+		for (unsigned k = 0; k <= edges; k++)
 		{
-			top_left.x = s_upper.left.x;
-			top_left.y = s_upper.left.y;
-			bottom_left.x = s_upper.left.x;
-			bottom_left.y = intersection(s_lower,top_left.x);
-		}
-		else
-		{
-			top_left.x = s_lower.left.x;
-			top_left.y = intersection(s_upper,top_left.x);
-			bottom_left.x = s_lower.left.x;
-			bottom_left.y = s_lower.left.y;
+			const double * e = k < edges ? &coordinates[4 * (size_t)(id + k)] : 0;
+			bool good = e && std::isfinite(e[0]) && std::isfinite(e[1]) && std::isfinite(e[2]) && std::isfinite(e[3]);
+			int d = !good ? 0 : (e[2] > e[0] ? 1 : (e[2] < e[0] ? -1 : 0));
+			if (k > first && d != dir)
+			{
+				add_chain(id + first, k - first, dir, color);
+				first = k;
+			}
+			if (d == 0)
+			{
+				// a vertical edge is nudged like any other, see add_segment()
+				if (good)
+					add_segment(e, id + k, color);
+				first = k + 1;
+			}
+			else if (k == first)
+				dir = d;
 		}
+		id += edges;
 	}
 
-	else if (s_upper == NULL_SEGMENT && s_lower != NULL_SEGMENT)
+	if (input.min_y() < y_min)
+		y_min = input.min_y();
+	if (input.max_y() > y_max)
+		y_max = input.max_y();
+}
+
+void TrapezoidSweep::add_chain(unsigned first_id, unsigned count, int dir, segment_color color)
+{
+	std::vector<double> & coordinates = color == RED ? red_coordinates : blue_coordinates;
+	if (count == 1)
 	{
-		top_left.x = s_lower.left.x;
-		top_left.y = y_max + 30;
-		top_right.y = y_max + 30;
-		bottom_right.y = s_lower.y_sweep;
-		bottom_left.x = s_lower.left.x;
-		bottom_left.y = s_lower.left.y;
+		add_segment(&coordinates[4 * (size_t)first_id], first_id, color);
+		return;
 	}
 
-	else if (s_lower == NULL_SEGMENT && s_upper != NULL_SEGMENT)
+	chain c;
+	c.at = chain_ids.size();
+	c.last = c.at + count;
+	for (unsigned k = 0; k < count; k++)
 	{
-		top_left.x = s_upper.left.x;
-		top_left.y = s_upper.left.y;
-		top_right.y = s_upper.y_sweep;
-		bottom_right.y = y_min - 30;
-		bottom_left.x = s_upper.left.x;
-		bottom_left.y = y_min - 30;
+		unsigned id = dir > 0 ? first_id + k : first_id + count - 1 - k;
+		const double * e = &coordinates[4 * (size_t)id];
+		chain_points.push_back(dir > 0 ? e[0] : e[2]);
+		chain_points.push_back(dir > 0 ? e[1] : e[3]);
+		chain_ids.push_back(id);
 	}
+	const double * e = &coordinates[4 * (size_t)(dir > 0 ? first_id + count - 1 : first_id)];
+	chain_points.push_back(dir > 0 ? e[2] : e[0]);
+	chain_points.push_back(dir > 0 ? e[3] : e[1]);
+	chain_ids.push_back((unsigned)NONE);	// no edge leaves the right end
+
+	endpoint left_point(chain_points[2 * c.at], chain_points[2 * c.at + 1]);
+	endpoint right_point(chain_points[2 * c.at + 2], chain_points[2 * c.at + 3]);
+	left_point.type = LEFT;
+	right_point.type = RIGHT;
+	segment * s = new segment(left_point, right_point, color);
+	s->id = chain_ids[c.at];
+	s->chain = (unsigned)chains.size();
+	chains.push_back(c);
+
+	for (size_t v = c.at; v <= c.last; v++)
+	{
+		endpoint p(chain_points[2 * v], chain_points[2 * v + 1]);
+		p.type = v == c.at ? LEFT : (v == c.last ? RIGHT : INNER);
+		queue.insert(std::make_pair(p, s));
+	}
+}
 
-	else //both NULL_SEGMENT
-	{			
-		top_left.x = x_sweep;
-		top_left.y = y_max + 30;
-		top_right.y = y_max + 30;
-		bottom_right.y = y_min - 30;
-		bottom_left.x = x_sweep;
-		bottom_left.y = y_min - 30;
-		if (current_endpoint.type == RIGHT)
-		{
-			top_left.x = current_segment.left.x;
-			bottom_left.x = current_segment.left.x;
-		}
-		else if (!queue.empty())
-		{
-			top_left.x = queue.begin()->first.x;
-			bottom_left.x = queue.begin()->first.x;
-		}
+/* the chain keeps its place in the list, unless a chain of the same color turns
+   across it at this vertex: only the neighbors can share its y_sweep, so if they
+   stay on their sides of the new edge the order still holds */
+void TrapezoidSweep::next_edge(SweepStatus & segment_list, segment * s)
+{
+	chain & c = chains[s->chain];
+	c.at++;
+	segment edge(s->right, endpoint(chain_points[2 * c.at + 2], chain_points[2 * c.at + 3]), s->color);
+	edge.left.type = LEFT;
+	edge.right.type = RIGHT;
+	double tie = slope_tie(edge, false);
+
+	segment * above = next(segment_list, s, 1);
+	segment * below = next(segment_list, s, -1);
+	bool in_place = (above == &NULL_SEGMENT || above->y_sweep != s->y_sweep || above->y_tie > tie) &&
+		(below == &NULL_SEGMENT || below->y_sweep != s->y_sweep || below->y_tie < tie);
+	if (!in_place)
+		delete_segment(segment_list, s);
+
+	s->left = edge.left;
+	s->right = edge.right;
+	s->x0 = s->left.x;
+	s->id = chain_ids[c.at];
+	if (in_place)
+		segment_list.retie(s, tie);
+	else
+	{
+		s->y_tie = tie;
+		insert_segment(segment_list, s);
 	}
+}
+
+void TrapezoidSweep::add_trapezoid(const segment * s_upper, const segment * s_lower)
+{
+	trapezoid t;
+	t.upper = s_upper == &NULL_SEGMENT ? NONE : s_upper->id;
+	t.lower = s_lower == &NULL_SEGMENT ? NONE : s_lower->id;
+	t.right_x = x_sweep;
+
+	// starts where the later of its segments starts
+	if (t.upper != NONE && t.lower != NONE)
+		t.left_x = s_upper->left > s_lower->left ? s_upper->left.x : s_lower->left.x;
+	else if (t.upper != NONE)
+		t.left_x = s_upper->left.x;
+	else if (t.lower != NONE)
+		t.left_x = s_lower->left.x;
+	else if (current_endpoint.type != LEFT)
+		t.left_x = current_segment.left.x;
+	else if (!queue.empty())
+		t.left_x = queue.begin()->first.x;
+	else
+		t.left_x = x_sweep;
 
-	walls.push_back(top_right.x);
-	walls.push_back(top_right.y);
-	walls.push_back(bottom_right.x);
-	walls.push_back(bottom_right.y);
+	current_t.push_back(t);
+}
 
-	current_t.push_back(top_left.x);
-	current_t.push_back(top_left.y);
-	current_t.push_back(bottom_left.x);
-	current_t.push_back(bottom_left.y);
-	current_t.push_back(bottom_right.x);
-	current_t.push_back(bottom_right.y);
-	current_t.push_back(top_right.x);
-	current_t.push_back(top_right.y);
+void TrapezoidSweep::trapezoid_corners(const std::vector<double> & blue_endpoints, const trapezoid * first,
+	size_t count, double bottom, double top, std::vector<double> & corners)
+{
+	size_t out = corners.size();
+	corners.resize(out + 8 * count);
+	for (size_t i = 0; i < count; i++)
+	{
+		const trapezoid & t = first[i];
+		double * c = &corners[out + 8 * i];
+		c[0] = c[2] = t.left_x;
+		c[4] = c[6] = t.right_x;
+		c[1] = side_y(blue_endpoints, t.upper, true, t.left_x, bottom, top);
+		c[3] = side_y(blue_endpoints, t.lower, false, t.left_x, bottom, top);
+		c[5] = side_y(blue_endpoints, t.lower, false, t.right_x, bottom, top);
+		c[7] = side_y(blue_endpoints, t.upper, true, t.right_x, bottom, top);
+	}
+}
+
+void TrapezoidSweep::trapezoid_walls(const std::vector<double> & blue_endpoints, const trapezoid * first,
+	size_t count, double bottom, double top, std::vector<double> & walls)
+{
+	size_t out = walls.size();
+	walls.resize(out + 4 * count);
+	for (size_t i = 0; i < count; i++)
+	{
+		const trapezoid & t = first[i];
+		double * w = &walls[out + 4 * i];
+		w[0] = w[2] = t.right_x;
+		w[1] = side_y(blue_endpoints, t.upper, true, t.right_x, bottom, top);
+		w[3] = side_y(blue_endpoints, t.lower, false, t.right_x, bottom, top);
+	}
 }
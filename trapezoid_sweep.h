@@ -2,73 +2,176 @@
 #define TRAPEZOID_SWEEP_H_
 
 #include <vector>
-#include <set>
 #include <map>
 #include <iterator>
 
 #include "segment.h"
+#include "sweep_status.h"
+#include "thread_pool.h"
+
+class BulkInput;
 
 class TrapezoidSweep
 {
+	// feeds the events from disk through process_event()
+	friend class ExternalSweep;
+
+	// runs it without keeping the trapezoids
+	friend class Overlay;
+
 public:
+	static const unsigned NONE = 0xffffffff;
+
+	/* the part of the plane between the blue segments upper and lower, by id, and
+	   the vertical walls at left_x and right_x; the corners lie on the segments, so
+	   they are computed when drawn */
+	struct trapezoid
+	{
+		unsigned upper, lower;		// NONE if unbounded
+		double left_x, right_x;
+	};
+
 	TrapezoidSweep(){}
-	TrapezoidSweep(const std::vector<double>&, const std::vector<double>&);
-	~TrapezoidSweep(){}
+	// status picks the structure of the lists of segments crossing the sweep line
+	TrapezoidSweep(const std::vector<double>&, const std::vector<double>&, status_structure status = STATUS_TREE);
+
+	/* sweeps only the window [x0,x1) x [y0,y1): the segments are clipped to it, grown
+	   by a hair so a crossing on its edges lies inside the clipped parts, the sweep
+	   starts at its left edge and stops at its right edge, and only the intersections
+	   inside are reported; windows tiling the plane report every intersection once */
+	TrapezoidSweep(const std::vector<double>& blue_endpoints, const std::vector<double>& red_endpoints,
+		double x0, double y0, double x1, double y1, status_structure status = STATUS_TREE);
+
+	/* polylines as x,y of their vertices, ids count their edges in input order; each
+	   polyline is cut into x-monotone chains, which stay in the lists of segments
+	   crossing the sweep line from end to end and take their next edge in place at
+	   the vertices in between */
+	TrapezoidSweep(const std::vector<std::vector<double> >& blue_polylines,
+		const std::vector<std::vector<double> >& red_polylines, status_structure status = STATUS_TREE);
+
+	// frees the segments, each is queued once at its left end
+	~TrapezoidSweep();
 
 	bool next_step();
 	double sweepline_x() const { return x_sweep; }
 	double x_red() const { return x0_red; }
-	std::vector<double> intersections() const { return m_intersections; }
-	std::vector<double> current() const { return current_t; }
-	std::vector<double> finished() const { return finished_t; }
-	std::vector<double> trapezoid_walls() const { return walls; }
+	// x,y of every intersection found so far, computed from the pairs on first use
+	const std::vector<double> & intersections() const;
+
+	/* red id, blue id of every intersection found so far, ids count the segments
+	   of each color in input order */
+	const std::vector<unsigned> & intersecting_pairs() const { return pairs; }
+
+	/* x,y for each red id, blue id pair in the format of intersecting_pairs(); a pair
+	   with an id that is not a segment of the sweep gets NaN, NaN and a warning is logged */
+	std::vector<double> intersection_points(const std::vector<unsigned> & pairs) const;
+
+	const std::vector<trapezoid> & current() const { return current_t; }
+	const std::vector<trapezoid> & finished() const { return finished_t; }
+
+	// y of the unbounded sides, a margin beyond the input
+	double trapezoid_top() const { return y_max + 30; }
+	double trapezoid_bottom() const { return y_min - 30; }
+
+	/* appends x,y of the top left, bottom left, bottom right and top right corner of
+	   each trapezoid, from the blue input the sweep was given; y is kept in [bottom, top] */
+	static void trapezoid_corners(const std::vector<double> & blue_endpoints, const trapezoid * first,
+		size_t count, double bottom, double top, std::vector<double> & corners);
+
+	// appends x,y of the top and bottom end of the right wall of each trapezoid
+	static void trapezoid_walls(const std::vector<double> & blue_endpoints, const trapezoid * first,
+		size_t count, double bottom, double top, std::vector<double> & walls);
+
+	// x1,y1,x2,y2 of the edges of the polylines by id, the segments the polyline sweep reports on
+	static std::vector<double> polyline_edges(const std::vector<std::vector<double> > & polylines);
 	segment_color current_segment_color() const { return current_segment.color; }
 
+	// input_error flags of both inputs
+	unsigned input_errors() const { return input_flags; }
+
 	// sweeps the endpoints from left to right
 	bool sweep() { for (;!next_step();); return true; }
+
+	/* true as soon as some red segment is found to meet a blue one, their ids
+	   are the witness; nothing is kept for drawing and segments outside the
+	   bounding box of the other color are not swept at all */
+	static bool find_intersection(const std::vector<double>& blue_endpoints,
+		const std::vector<double>& red_endpoints, unsigned & red_id, unsigned & blue_id);
+
+	/* intersections inside [x0,x1) x [y0,y1) from a columns x rows grid of windowed
+	   sweeps spread over the pool, in the format of intersections(), tile by tile */
+	static std::vector<double> tiled_intersections(const std::vector<double>& blue_endpoints,
+		const std::vector<double>& red_endpoints, double x0, double y0, double x1, double y1,
+		unsigned columns, unsigned rows, ThreadPool &);
 	
 	double current_endpoint_x() const;
 	double current_endpoint_y() const;
 
 private:
-	std::map<endpoint,segment*> queue;	// queue lexicographically sorted by a point coordinate
-	double x_sweep;				// x-coordinate of the sweep line
-	double x0_red;				// largest x-coordinate of the reported intersection of s_red
-
-	struct set_comp
+	// lexicographic, at a point the segments ending there, then the chains going on, then the segments starting there
+	struct event_order
 	{
-		bool operator () (const segment *s1, const segment *s2) const
+		static int rank(endpoint_type t) { return t == RIGHT ? 0 : (t == INNER ? 1 : 2); }
+		bool operator () (const endpoint & a, const endpoint & b) const
 		{
-			return s1->y_sweep < s2->y_sweep;
+			return a < b || (a == b && rank(a.type) < rank(b.type));
 		}
 	};
 
+	// x-monotone run of polyline edges swept as one segment
+	struct chain
+	{
+		size_t at;		// left vertex of the current edge in chain_points
+		size_t last;		// right end of the chain
+	};
+
+	// queue lexicographically sorted by a point coordinate, endpoints shared by segments appear once per segment
+	std::multimap<endpoint,segment*,event_order> queue;
+	double x_sweep;				// x-coordinate of the sweep line
+	double x_keys;				// x_sweep the keys in the lists were last set at
+	double x0_red;				// largest x-coordinate of the reported intersection of s_red
+
 	// lists of segments intersecting the sweep line
 	// ordered by y-intersection with x_sweep
-	std::set<segment*, set_comp> L_red;
-	std::set<segment*, set_comp> L_blue;
+	SweepStatus L_red;
+	SweepStatus L_blue;
+
+	std::vector<unsigned> pairs;		// intersections found so far
+	mutable std::vector<double> m_intersections;	// points of the pairs, filled in by intersections()
 
-	std::vector<double> m_intersections;	// intersections found so far
-	std::vector<double> finished_t;		// closed trapezoids
-	std::vector<double> current_t;		// trapezoids being processed
-	std::vector<double> walls;
+	// x1,y1,x2,y2 of each segment by id, as given
+	std::vector<double> red_coordinates;
+	std::vector<double> blue_coordinates;
+
+	// vertices of all chains left to right, x,y and the id of the edge leaving each to the right
+	std::vector<double> chain_points;
+	std::vector<unsigned> chain_ids;
+	std::vector<chain> chains;
+	std::vector<trapezoid> finished_t;	// closed trapezoids
+	std::vector<trapezoid> current_t;	// trapezoids being processed
 
 	double y_min, y_max;
+	unsigned input_flags;
 	bool done;					//sweeping finished
-	std::map<endpoint,segment*>::iterator queue_it; //iterator to current endpoint
+	bool detect_only;				//stop at the first intersection
+	bool keep_trapezoids;				//false if nobody draws them
+	bool windowed;					//segments clipped to window, reports inside it only
+	double window[4];				//x0, y0, x1, y1
+	double clip_box[4];				//window grown by WINDOW_MARGIN, segments are clipped to it
+	std::multimap<endpoint,segment*,event_order>::iterator queue_it; //iterator to current endpoint
 	endpoint current_endpoint;			//endpoint being processed
 	segment current_segment;			//segment being processed
 	endpoint NULL_POINT;
 	segment NULL_SEGMENT;
 
-	void insert_segment(std::set<segment*,set_comp>&, segment*);
-	void delete_segment(std::set<segment*,set_comp>&, segment*);
+	void insert_segment(SweepStatus&, segment*);
+	void delete_segment(SweepStatus&, segment*);
 
 	// returns the element in list L that is just grater (or less) that s if dir = +1/-1
-	segment* search(std::set<segment*,set_comp>&, segment*, int);
+	segment* search(SweepStatus&, segment*, int);
 
 	// returns the successor / predecssor of s in list L if dir = +1/-1
-	segment* next(std::set<segment*,set_comp>&, segment*, int);
+	segment* next(SweepStatus&, segment*, int);
 
 	double intersection(segment, double) const;
 	endpoint intersection(segment, segment) const;
@@ -77,15 +180,41 @@ private:
 	//otherwise return the x-coordinate of the intersection
 	double meet(segment, segment) const;
 
+	void process_event(const endpoint &, segment *);
 	void report(const segment*, const segment*);
-	void update_y_sweep(std::set<segment*,set_comp>&);
+	void update_y_sweep(SweepStatus&);
 
 	/* for each s*_red that intersects s*, reports the intersection of s*_red with s*
 	   and the intersections of s*_red with all other s*_blue to left of that intersection */
 	void advance(segment*);
 
-	void init_queue(const std::vector<double>&, segment_color);
-	void add_trapezoid(segment, segment);
+	// clip_window is x0, y0, x1, y1 for a windowed sweep, 0 otherwise
+	void init(const BulkInput & blue, const BulkInput & red, bool detect, const double * clip_window,
+		status_structure status = STATUS_TREE);
+
+	/* box is min_x, min_y, max_x, max_y, segments outside are left out, 0 keeps all;
+	   in a windowed sweep the rest are clipped to clip_box */
+	void init_queue(const BulkInput &, segment_color, const double * box);
+
+	// lists the segments starting on the left edge of clip_box, the sweep starts after their events
+	void list_left_edge();
+
+	// queues x1,y1,x2,y2 at c as a segment of its own
+	void add_segment(const double * c, unsigned id, segment_color);
+
+	// queues the polylines as chains of the edges in coordinates, which are filled in first
+	void init_chains(const std::vector<std::vector<double> > & polylines, segment_color);
+
+	// queues count edges from first_id on as a chain, dir is +1 if x grows with the ids and -1 if it shrinks
+	void add_chain(unsigned first_id, unsigned count, int dir, segment_color);
+
+	// moves s from the edge ending at x_sweep to the next edge of its chain
+	void next_edge(SweepStatus &, segment * s);
+	void add_trapezoid(const segment *, const segment *);
+
+	// the queue owns the segments
+	TrapezoidSweep(const TrapezoidSweep &);
+	TrapezoidSweep & operator = (const TrapezoidSweep &);
 };
 
 #endif
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <cmath>
+
+#include "view_index.h"
+
+namespace
+{
+	// side of the first root, doubled until the input fits
+	const double INITIAL_ROOT = 256;
+
+	// primitives a node keeps before new ones go to its children
+	const unsigned NODE_ITEMS = 8;
+
+	// largest tile side in tiles
+	const double TILE_SPAN = 4;
+}
+
+ViewIndex::node::node(double x, double y, double size)
+	: x(x), y(y), size(size), min_x(HUGE_VAL), min_y(HUGE_VAL), max_x(-HUGE_VAL), max_y(-HUGE_VAL), count(0)
+{
+	child[0] = child[1] = child[2] = child[3] = -1;
+}
+
+ViewIndex::ViewIndex(unsigned corners, double min_node)
+	: corners(corners), min_node(min_node), synced(0), root(-1), changed(true)
+{
+}
+
+void ViewIndex::sync(const std::vector<double> & array)
+{
+	if (array.size() < synced)
+		synced = 0;
+	if (synced == 0 && !nodes.empty())
+	{
+		nodes.clear();
+		root = -1;
+		changed = true;
+	}
+
+	size_t whole = array.size() - array.size() % (2 * corners);
+	if (whole <= synced)
+		return;
+
+	for (size_t p = synced / (2 * corners); p < whole / (2 * corners); p++)
+		insert(&array[0], (unsigned)p);
+	synced = whole;
+	changed = true;
+}
+
+void ViewIndex::query(const std::vector<double> & array, double x0, double y0, double x1, double y1, double tile, double pad)
+{
+	double view[] = { x0, y0, x1, y1, tile, pad };
+	if (!changed && std::equal(view, view + 6, last_query))
+		return;
+	std::copy(view, view + 6, last_query);
+	changed = false;
+
+	visible_vertices.clear();
+	tile_vertices.clear();
+	if (root >= 0)
+		collect(&array[0], root, view, tile, pad);
+}
+
+void ViewIndex::insert(const double * coordinates, unsigned primitive)
+{
+	const double * c = &coordinates[primitive * 2 * corners];
+	double min_x = c[0], max_x = c[0], min_y = c[1], max_y = c[1];
+	for (unsigned i = 1; i < corners; i++)
+	{
+		min_x = std::min(min_x, c[2*i]);
+		max_x = std::max(max_x, c[2*i]);
+		min_y = std::min(min_y, c[2*i + 1]);
+		max_y = std::max(max_y, c[2*i + 1]);
+	}
+
+	// GL drops primitives with infinite coordinates, they are never visible
+	if (!(min_x > -HUGE_VAL && max_x < HUGE_VAL && min_y > -HUGE_VAL && max_y < HUGE_VAL))
+		return;
+
+	double extent = std::max(max_x - min_x, max_y - min_y);
+	double cx = (min_x + max_x) / 2;
+	double cy = (min_y + max_y) / 2;
+	grow(cx, cy, extent);
+
+	/* down by the center while the child would still be as large as the primitive
+	   and this node is full or has the child already */
+	int n = root;
+	for (;;)
+	{
+		node & d = nodes[n];
+		d.min_x = std::min(d.min_x, min_x);
+		d.max_x = std::max(d.max_x, max_x);
+		d.min_y = std::min(d.min_y, min_y);
+		d.max_y = std::max(d.max_y, max_y);
+		d.count++;
+
+		double half = d.size / 2;
+		if (half < extent || half < min_node)
+			break;
+
+		int q = (cx >= d.x + half ? 1 : 0) + (cy >= d.y + half ? 2 : 0);
+		if (d.child[q] < 0)
+		{
+			if (d.items.size() < NODE_ITEMS)
+				break;
+			node below(d.x + (q & 1) * half, d.y + (q >> 1) * half, half);
+			nodes.push_back(below);
+			nodes[n].child[q] = (int)nodes.size() - 1;
+		}
+		n = nodes[n].child[q];
+	}
+	nodes[n].items.push_back(primitive);
+}
+
+// puts new roots above the old one until the root contains the center and is large enough
+void ViewIndex::grow(double cx, double cy, double extent)
+{
+	if (root < 0)
+	{
+		double size = INITIAL_ROOT;
+		while (size < extent)
+			size *= 2;
+		nodes.push_back(node(std::floor(cx / size) * size, std::floor(cy / size) * size, size));
+		root = 0;
+	}
+
+	for (;;)
+	{
+		const node & r = nodes[root];
+		if (extent <= r.size && cx >= r.x && cx < r.x + r.size && cy >= r.y && cy < r.y + r.size)
+			return;
+
+		node above(cx < r.x ? r.x - r.size : r.x, cy < r.y ? r.y - r.size : r.y, 2 * r.size);
+		above.child[(r.x > above.x ? 1 : 0) + (r.y > above.y ? 2 : 0)] = root;
+		above.min_x = r.min_x;
+		above.min_y = r.min_y;
+		above.max_x = r.max_x;
+		above.max_y = r.max_y;
+		above.count = r.count;
+		nodes.push_back(above);
+		root = (int)nodes.size() - 1;
+	}
+}
+
+void ViewIndex::collect(const double * coordinates, int n, const double * view, double tile, double pad)
+{
+	const node & d = nodes[n];
+	if (d.count == 0 || d.max_x < view[0] || d.min_x > view[2] || d.max_y < view[1] || d.min_y > view[3])
+		return;
+
+	/* contents a few tiles across with at least one primitive per tile of their
+	   area become a single tile over them, that is everything smaller than a
+	   tile too; larger nodes could hide holes under the tile */
+	double width = d.max_x - d.min_x + tile;
+	double height = d.max_y - d.min_y + tile;
+	if (d.count > 1 && width <= TILE_SPAN * tile && height <= TILE_SPAN * tile && width * height <= d.count * tile * tile)
+	{
+		float x0 = (float)(d.min_x - pad), y0 = (float)(d.min_y - pad);
+		float x1 = (float)(d.max_x + pad), y1 = (float)(d.max_y + pad);
+		float quad[] = { x0, y0, x1, y0, x1, y1, x0, y1 };
+		tile_vertices.insert(tile_vertices.end(), quad, quad + 8);
+		return;
+	}
+
+	for (unsigned i = 0; i < d.items.size(); i++)
+	{
+		const double * c = &coordinates[d.items[i] * 2 * corners];
+		double min_x = c[0], max_x = c[0], min_y = c[1], max_y = c[1];
+		for (unsigned k = 1; k < corners; k++)
+		{
+			min_x = std::min(min_x, c[2*k]);
+			max_x = std::max(max_x, c[2*k]);
+			min_y = std::min(min_y, c[2*k + 1]);
+			max_y = std::max(max_y, c[2*k + 1]);
+		}
+		if (max_x < view[0] || min_x > view[2] || max_y < view[1] || min_y > view[3])
+			continue;
+		for (unsigned k = 0; k < corners; k++)
+			visible_vertices.push_back(d.items[i] * corners + k);
+	}
+
+	for (int q = 0; q < 4; q++)
+	{
+		if (d.child[q] >= 0)
+			collect(coordinates, d.child[q], view, tile, pad);
+	}
+}
@@ -0,0 +1,68 @@
+#ifndef VIEW_INDEX_H_
+#define VIEW_INDEX_H_
+
+#include <vector>
+#include <cstddef>
+
+/* loose quadtree over a growing array of primitives, each given by 1, 2 or 4
+   x,y corners (points, lines, quads), for drawing only what is in view: a
+   primitive goes down by its center to a node with room that is at least as
+   large as its bounding box, nodes keep the bounding box and the number of
+   primitives below them.
+   small nodes with at least one primitive per tile of their area are drawn as
+   one tile over their contents, so the drawing grows with the screen and not with
+   the number of primitives.
+   the array is not copied, every call gets the same array again; it may only
+   grow until reset(), the visible primitives are drawn from it by vertex number */
+class ViewIndex
+{
+public:
+	// nodes are not split below min_node
+	ViewIndex(unsigned corners, double min_node);
+
+	// indexes the primitives added since the last sync, all of them if the array got shorter
+	void sync(const std::vector<double> & array);
+
+	// the next sync indexes everything, for arrays that were rebuilt
+	void reset() { synced = 0; }
+
+	/* collects the primitives overlapping the view [x0,x1]x[y0,y1] and the tiles
+	   for dense contents, tiles are grown by pad on every side;
+	   nothing is done if neither the view nor the primitives changed */
+	void query(const std::vector<double> & array, double x0, double y0, double x1, double y1, double tile, double pad);
+
+	// vertex numbers of the visible primitives in the array and 4 corners per tile, from the last query
+	const std::vector<unsigned> & visible() const { return visible_vertices; }
+	const std::vector<float> & tiles() const { return tile_vertices; }
+
+	unsigned size() const { return (unsigned)(synced / (2 * corners)); }
+
+private:
+	struct node
+	{
+		double x, y, size;			// square [x,x+size) x [y,y+size)
+		double min_x, min_y, max_x, max_y;	// bounding box of everything below
+		unsigned count;				// primitives below
+		std::vector<unsigned> items;		// primitives kept here
+		int child[4];				// -1 if none, quadrant 1 is right, 2 is up
+
+		node(double x, double y, double size);
+	};
+
+	unsigned corners;
+	double min_node;
+	size_t synced;				// coordinates of the array indexed
+	std::vector<node> nodes;		// nodes[root] contains all others
+	int root;
+
+	std::vector<unsigned> visible_vertices;
+	std::vector<float> tile_vertices;
+	bool changed;
+	double last_query[6];
+
+	void insert(const double * coordinates, unsigned primitive);
+	void grow(double x, double y, double extent);
+	void collect(const double * coordinates, int n, const double * view, double tile, double pad);
+};
+
+#endif